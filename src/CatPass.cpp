@@ -4,8 +4,25 @@
 ///
 /// Michael Huyler
 
+#include "CatPass.h"
+
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/ConstantFolding.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/CFG.h"
 #include "llvm/IR/Dominators.h"
@@ -14,144 +31,403 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
 #include "llvm/Pass.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Passes/PassPlugin.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/PromoteMemToReg.h"
+#include "llvm/Transforms/Utils/SSAUpdater.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <numeric>
+#include <thread>
 
 using namespace llvm;
+using namespace cat;
+
+#define DEBUG_TYPE "CAT"
+
+STATISTIC(NumBlockVisits, "Number of blocks visited by the IN/OUT worklist");
+STATISTIC(NumSweepsSaved, "Number of full IN/OUT sweeps saved by the worklist");
+STATISTIC(NumFunctionsSkipped, "Number of functions skipped for not calling the CAT API");
+STATISTIC(NumModRefQueries, "Number of mod/ref queries made to alias analysis");
+STATISTIC(NumModRefCacheHits, "Number of mod/ref queries answered by the cache");
+STATISTIC(NumSCCPVisits, "Number of Instructions visited by the SCCP engine");
+STATISTIC(NumSliceVisits, "Number of blocks visited by the per-variable reaching definitions");
+STATISTIC(NumPromoted, "Number of CAT variables promoted to SSA registers");
+STATISTIC(NumSimplified, "Number of CAT_add and CAT_sub calls simplified by an algebraic identity");
+STATISTIC(NumRedundantGets, "Number of redundant CAT_get calls removed");
+STATISTIC(NumGetsInserted, "Number of CAT_get calls inserted to make partially redundant ones fully redundant");
+STATISTIC(NumInductionVariables, "Number of CAT induction variables rewritten in closed form");
+STATISTIC(NumHoisted, "Number of CAT API calls hoisted out of loops");
+STATISTIC(NumDeadDefinitions, "Number of dead CAT definitions removed");
+STATISTIC(NumFixpointRounds, "Number of extra rounds of constant propagation and folding");
+
+static cl::opt<bool> UseSCCP("cat-sccp", cl::init(false),
+	cl::desc("Find CAT constants with sparse conditional constant propagation instead of reaching definitions"));
+static cl::opt<bool> UseSimplification("cat-simplify", cl::init(false),
+	cl::desc("Simplify CAT_add and CAT_sub calls with algebraic identities before and after propagation"));
+static cl::opt<bool> UseRedundantGets("cat-gvn", cl::init(false),
+	cl::desc("Share the result of CAT_get calls reading a CAT variable that was not redefined in between"));
+static cl::opt<bool> UseInductionVariables("cat-indvars", cl::init(false),
+	cl::desc("Rewrite CAT induction variables of loops with a constant trip count in closed form"));
+static cl::opt<bool> UseHoisting("cat-licm", cl::init(false),
+	cl::desc("Hoist loop-invariant CAT_get, CAT_set, CAT_add and CAT_sub calls into loop preheaders"));
+static cl::opt<bool> UseDeadDefinitions("cat-dce", cl::init(false),
+	cl::desc("Remove definitions of CAT variables that are never read"));
+static cl::opt<bool> UseSlices("cat-sliced", cl::init(false),
+	cl::desc("Solve the reaching definitions of each CAT variable separately, over the blocks its definitions reach"));
+static cl::opt<unsigned> Threads("cat-threads", cl::init(0),
+	cl::desc("Number of threads analyzing functions under -CAT-parallel, or 0 for one per hardware thread"));
+static cl::opt<bool> UseFixpoint("cat-fixpoint", cl::init(false),
+	cl::desc("Repeat constant propagation and folding until nothing changes, updating only the values the rewrites affect"));
+static cl::opt<bool> UsePromotion("cat-promote", cl::init(false),
+	cl::desc("Promote CAT variables that never escape their function to SSA registers"));
 
 namespace {
 	/// <summary>
-	/// This struct holds a list of CAT API function names.
+	/// This struct holds a list of CAT API function names, indexed by their opcode.
 	/// </summary>
 	struct CAT_API {
 	public:
+		/// The kind of a call; calls to any other function, or to an unknown function, are <c>CALL</c>
+		enum Opcode { ADD, SUB, NEW, GET, SET, CALL };
 		const static std::vector<std::string> API;
 	};
 	const std::vector<std::string> CAT_API::API{ "CAT_add", "CAT_sub", "CAT_new", "CAT_get", "CAT_set" };
 
-	/// A pointer to the Module for use in IR building
-	Module* mod;
+	/// <summary>
+	/// This struct holds the algebraic identities of CAT_add and CAT_sub, which hold whatever the
+	/// values of the CAT variables are. A call <c>op(x, y, z)</c> matching <c>pattern</c> is rewritten as <c>rewrite</c>.
+	/// </summary>
+	struct CAT_IDENTITY {
+	public:
+		/// <para>SAME_OPERANDS: y and z are the same CAT variable</para>
+		/// <para>ZERO_1, ZERO_2: y (resp. z) is known to be 0 where it is read</para>
+		/// <para>DEST_2: z is x, but y is not</para>
+		enum Pattern { SAME_OPERANDS, ZERO_1, ZERO_2, DEST_2 };
+		/// <para>SET_ZERO: x = 0</para>
+		/// <para>COPY_1, COPY_2: x = y (resp. z), only applied when that is x itself, removing the call</para>
+		/// <para>COMMUTE: x = z + y, so that x comes first</para>
+		enum Rewrite { SET_ZERO, COPY_1, COPY_2, COMMUTE };
+
+		CAT_API::Opcode op;
+		Pattern pattern;
+		Rewrite rewrite;
+		const static std::vector<CAT_IDENTITY> TABLE;
+	};
+	const std::vector<CAT_IDENTITY> CAT_IDENTITY::TABLE{
+		{ CAT_API::SUB, SAME_OPERANDS, SET_ZERO },	// x = y - y
+		{ CAT_API::ADD, ZERO_2, COPY_1 },			// x = y + 0
+		{ CAT_API::ADD, ZERO_1, COPY_2 },			// x = 0 + z
+		{ CAT_API::SUB, ZERO_2, COPY_1 },			// x = y - 0
+		{ CAT_API::ADD, DEST_2, COMMUTE },			// x = y + x
+	};
 
 	/// <summary>
-	/// This struct holds DFA sets for a particular <c>Instruction</c>:
-	/// <para>GEN, KILL, IN, OUT</para>
-	/// It also provides functions for adding to these sets
-	/// and retreiving the <c>Instruction</c> to which these sets belong.
+	/// This struct holds the dataflow state of the function being analyzed as a struct of arrays:
+	/// <para>definitions: the <c>Instruction</c> that (re)defines a CAT variable, and that variable</para>
+	/// <para>CAT variables: the indices of all of their definitions</para>
+	/// <para>BasicBlocks: their range of definitions and their GEN, KILL, IN, OUT SETs</para>
+	/// Every SET is a row of words in a single arena. The arena and the other arrays are
+	/// cleared, not freed, between functions, so once they have grown to fit the largest
+	/// function of a module no further heap allocations are made.
+	/// A definition GENs itself and KILLs every other definition of the same CAT variable,
+	/// so the GEN and KILL SETs of a single definition are never stored explicitly.
 	/// </summary>
-	struct DFA_SET {
+	struct DFA_STATE {
 	public:
-		DFA_SET(Instruction* I) : m_inst(I) {}
-		Instruction* getInstruction() const {
-			return m_inst;
-		}
-		BitVector* get_gen() {
-			return &m_gen;
-		};
-		BitVector* get_kill() {
-			return &m_kill;
-		};
-		BitVector* get_in() {
-			return &m_in;
-		};
-		BitVector* get_out() {
-			return &m_out;
-		};
-		BitVector* getAliases() { return &aliases; }
-		void print(std::vector<DFA_SET*>* dfa);
-		bool escapes();
-		// Convenience functions to add Instructions to SETs
-		void add(const int i, const int set);
-		void add(const BitVector* i, const int set);
-		// SET modification flags
+		typedef uint64_t Word;
+		// SET flags
 		const static int GEN{ 0 };
 		const static int KILL{ 1 };
 		const static int IN{ 2 };
 		const static int OUT{ 3 };
-		const static int ALIAS{ 4 };
-	private:
-		Instruction* m_inst;
+		const static int NUM_SETS{ 4 };
+		// Scratch SETs available after initSets()
+		const static int NUM_SCRATCH{ 2 };
+
+		void clear();
+		int addDefinition(Instruction* I, Value* V);
+		int addBlock(BasicBlock* B);
+		void finalize();
+		void initSets();
+		void print(int block);
+
+		// Definitions
+		int numDefinitions() const {
+			return m_def_inst.size();
+		}
+		Instruction* getInstruction(int def) const {
+			return m_def_inst[def];
+		}
+		Value* getVariable(int def) const {
+			return m_vars[m_def_var[def]];
+		}
+		int getVariableIndex(int def) const {
+			return m_def_var[def];
+		}
+		/// Returns the index of the first definition made by I, or -1
+		int getDefinition(const Instruction* I) const {
+			auto iter{ m_def_index.find(I) };
+			return iter == m_def_index.end() ? -1 : iter->second;
+		}
+		/// Makes I the Instruction of the definitions made by the Instruction of def, when I replaced it
+		void setInstruction(int def, Instruction* I) {
+			auto old{ m_def_inst[def] };
+			m_def_index.erase(old);
+			m_def_index[I] = def;
+			for (auto i = def; i < m_def_inst.size() && m_def_inst[i] == old; i++) {
+				m_def_inst[i] = I;
+			}
+		}
+		/// Returns the indices of every definition of the CAT variable V
+		ArrayRef<int> getDefinitions(const Value* V) const {
+			auto iter{ m_var_index.find(V) };
+			if (iter == m_var_index.end()) { return ArrayRef<int>(); }
+			return getVariableDefinitions(iter->second);
+		}
+
+		// CAT variables
+		int numVariables() const {
+			return m_vars.size();
+		}
+		/// Returns the index of the CAT variable V, or -1 if V is never defined
+		int getVariableIndex(const Value* V) const {
+			auto iter{ m_var_index.find(V) };
+			return iter == m_var_index.end() ? -1 : iter->second;
+		}
+		/// Returns the indices of every definition of a CAT variable, after finalize()
+		ArrayRef<int> getVariableDefinitions(int var) const {
+			return ArrayRef<int>(m_var_defs.data() + m_var_begin[var], m_var_begin[var + 1] - m_var_begin[var]);
+		}
+
+		// BasicBlocks
+		int numBlocks() const {
+			return m_blocks.size();
+		}
+		BasicBlock* getBlock(int block) const {
+			return m_blocks[block];
+		}
+		/// Returns the index of B, or -1 if B is unreachable
+		int getBlockIndex(const BasicBlock* B) const {
+			auto iter{ m_block_index.find(B) };
+			return iter == m_block_index.end() ? -1 : iter->second;
+		}
+		/// Index of the first definition in a block
+		int getEntry(int block) const {
+			return m_block_entry[block];
+		}
+		/// Index one past the last definition in a block
+		int getExit(int block) const {
+			return block + 1 < m_blocks.size() ? m_block_entry[block + 1] : numDefinitions();
+		}
+
 		// SETs
-		BitVector m_gen;
-		BitVector m_kill;
-		BitVector m_in;
-		BitVector m_out;
-		BitVector aliases;
+		Word* getSet(int block, int set) {
+			return &m_words[(block * NUM_SETS + set) * m_row_words];
+		}
+		Word* getScratch(int n) {
+			return &m_words[(m_blocks.size() * NUM_SETS + n) * m_row_words];
+		}
+		bool test(const Word* s, int i) const {
+			return (s[i / 64] >> (i % 64)) & 1;
+		}
+		void set(Word* s, int i) const {
+			s[i / 64] |= Word(1) << (i % 64);
+		}
+		void reset(Word* s, int i) const {
+			s[i / 64] &= ~(Word(1) << (i % 64));
+		}
+		void clear(Word* s) const;
+		void copy(Word* dst, const Word* src) const;
+		void merge(Word* dst, const Word* src) const;
+		bool equals(const Word* l, const Word* r) const;
+		void transfer(Word* s, int block);
+		void apply(Word* s, int def) const;
+
+		// CAT variables that escape through memory
+		SetVector<Value*> escaping;
+	private:
+		// Definitions
+		std::vector<Instruction*> m_def_inst;
+		std::vector<int> m_def_var;
+		DenseMap<const Instruction*, int> m_def_index;
+		// CAT variables; the definitions of variable v are m_var_defs[m_var_begin[v] ... m_var_begin[v + 1] - 1]
+		std::vector<Value*> m_vars;
+		DenseMap<const Value*, int> m_var_index;
+		std::vector<int> m_var_begin;
+		std::vector<int> m_var_defs;
+		// BasicBlocks; the definitions of block b are m_block_entry[b] ... getExit(b) - 1
+		std::vector<BasicBlock*> m_blocks;
+		std::vector<int> m_block_entry;
+		DenseMap<const BasicBlock*, int> m_block_index;
+		// The arena holding every SET, m_row_words words per SET
+		std::vector<Word> m_words;
+		int m_row_words{ 0 };
 	};
 
-	/// <summary>Adds an <c>Instruction</c> to a SET.</summary>
-	/// <param name='i'>The index of the <c>Instruction</c> to be added.</param>
-	/// <param name='set'>A flag indicating the destination SET.</param>
-	void DFA_SET::add(const int i, const int set) {
-		switch (set) {
-		case GEN:
-			if (m_gen.size() < i + 1) {
-				m_gen.resize(i + 1);
-			}
-			m_gen.set(i);
-			break;
-		case KILL:
-			if (m_kill.size() < i + 1) {
-				m_kill.resize(i + 1);
-			}
-			m_kill.set(i);
-			break;
-		case IN:
-			if (m_in.size() < i + 1) {
-				m_in.resize(i + 1);
-			}
-			m_in.set(i);
-			break;
-		case OUT:
-			if (m_out.size() < i + 1) {
-				m_out.resize(i + 1);
-			}
-			m_out.set(i);
-			break;
-		case ALIAS:
-			if (aliases.size() < i + 1) {
-				aliases.resize(i + 1);
-			}
-			aliases.set(i);
-			break;
-		default:
-			// errs() << ">>>> Invalid set ID: " << set << "\n";
-			break;
+	/// <summary>Forgets the current function, keeping all allocated memory for the next one.</summary>
+	void DFA_STATE::clear() {
+		m_def_inst.clear();
+		m_def_var.clear();
+		m_def_index.clear();
+		m_vars.clear();
+		m_var_index.clear();
+		m_var_begin.clear();
+		m_var_defs.clear();
+		m_blocks.clear();
+		m_block_entry.clear();
+		m_block_index.clear();
+		m_words.clear();
+		m_row_words = 0;
+		escaping.clear();
+	}
+
+	/// <summary>Adds a definition of a CAT variable to the current block.</summary>
+	/// <param name='I'>The <c>Instruction</c> (re)defining the CAT variable.</param>
+	/// <param name='V'>The CAT variable.</param>
+	/// <returns>The index of the new definition.</returns>
+	int DFA_STATE::addDefinition(Instruction* I, Value* V) {
+		int def = m_def_inst.size();
+		auto var_iter{ m_var_index.insert(std::pair<const Value*, int>(V, m_vars.size())) };
+		if (var_iter.second) {
+			m_vars.push_back(V);
+		}
+		m_def_index.insert(std::pair<const Instruction*, int>(I, def));
+		m_def_inst.push_back(I);
+		m_def_var.push_back(var_iter.first->second);
+		return def;
+	}
+
+	/// <summary>Starts a new block; the definitions added next belong to it.</summary>
+	/// <param name='B'>The reachable <c>BasicBlock</c>.</param>
+	/// <returns>The index of the new block.</returns>
+	int DFA_STATE::addBlock(BasicBlock* B) {
+		int block = m_blocks.size();
+		m_block_index[B] = block;
+		m_blocks.push_back(B);
+		m_block_entry.push_back(numDefinitions());
+		return block;
+	}
+
+	/// <summary>Indexes the definitions of every CAT variable, once every definition has been added.</summary>
+	void DFA_STATE::finalize() {
+		// Counting sort of the definitions by CAT variable, keeping program order
+		m_var_begin.assign(m_vars.size() + 1, 0);
+		for (auto var : m_def_var) {
+			m_var_begin[var + 1]++;
+		}
+		for (auto v = 0; v < m_vars.size(); v++) {
+			m_var_begin[v + 1] += m_var_begin[v];
 		}
+		m_var_defs.resize(m_def_var.size());
+		for (auto def = 0; def < m_def_var.size(); def++) {
+			m_var_defs[m_var_begin[m_def_var[def]]++] = def;
+		}
+		for (auto v = m_vars.size(); v > 0; v--) {
+			m_var_begin[v] = m_var_begin[v - 1];
+		}
+		m_var_begin[0] = 0;
 	}
 
-	/// <summary>Adds one SET to another SET.</summary>
-	/// <param name='v'><c>BitVector</c> SET to be integrated.</param>
-	/// <param name='set'>A flag indicating the destination SET.</param>
-	void DFA_SET::add(const BitVector* v, const int set) {
-		for (auto i = 0; i < v->size(); i++) {
-			if ((*v)[i]) {
-				add(i, set);
+	/// <summary>
+	/// Allocates every SET with the size of the universe and computes each block's
+	/// GEN and KILL SETs by folding the transfer functions of its definitions in program order.
+	/// </summary>
+	void DFA_STATE::initSets() {
+		// Allocate every SET at once
+		m_row_words = (numDefinitions() + 63) / 64;
+		m_words.assign((m_blocks.size() * NUM_SETS + NUM_SCRATCH) * m_row_words, 0);
+
+		for (auto block = 0; block < m_blocks.size(); block++) {
+			auto gen{ getSet(block, GEN) };
+			auto kill{ getSet(block, KILL) };
+			for (auto def = getEntry(block); def < getExit(block); def++) {
+				// GEN_B' = GEN_I U (GEN_B - KILL_I)
+				apply(gen, def);
+				// KILL_B' = KILL_B U KILL_I
+				for (auto i : getVariableDefinitions(m_def_var[def])) {
+					set(kill, i);
+				}
 			}
 		}
 	}
 
+	/// <summary>Empties a SET.</summary>
+	void DFA_STATE::clear(Word* s) const {
+		std::fill(s, s + m_row_words, 0);
+	}
+
+	/// <summary>Copies one SET to another.</summary>
+	void DFA_STATE::copy(Word* dst, const Word* src) const {
+		std::copy(src, src + m_row_words, dst);
+	}
+
+	/// <summary>Adds one SET to another SET: <para>dst = dst U src</para></summary>
+	void DFA_STATE::merge(Word* dst, const Word* src) const {
+		for (auto w = 0; w < m_row_words; w++) {
+			dst[w] |= src[w];
+		}
+	}
+
+	/// <summary>Tests if two SETs are equal.</summary>
+	bool DFA_STATE::equals(const Word* l, const Word* r) const {
+		return std::equal(l, l + m_row_words, r);
+	}
+
+	/// <summary>
+	/// Applies a block's GEN/KILL transfer function to a SET in place:
+	/// <para>s = GEN U (s - KILL)</para>
+	/// </summary>
+	/// <param name='s'>The SET to be transformed.</param>
+	/// <param name='block'>The index of the block.</param>
+	void DFA_STATE::transfer(Word* s, int block) {
+		auto gen{ getSet(block, GEN) };
+		auto kill{ getSet(block, KILL) };
+		for (auto w = 0; w < m_row_words; w++) {
+			s[w] = gen[w] | (s[w] & ~kill[w]);
+		}
+	}
+
+	/// <summary>Applies the transfer function of a single definition to a SET in place.</summary>
+	/// <param name='s'>The SET to be transformed.</param>
+	/// <param name='def'>The index of the definition.</param>
+	void DFA_STATE::apply(Word* s, int def) const {
+		// KILL every definition of the same CAT variable...
+		for (auto i : getVariableDefinitions(m_def_var[def])) {
+			reset(s, i);
+		}
+		// ...and GEN this one
+		set(s, def);
+	}
+
 	/// <summary>
-	/// Prints IN and OUT sets for a particular Instruction.
+	/// Prints IN and OUT sets for a particular BasicBlock.
 	/// </summary>
-	/// <param name="dfa">The collection of DFA sets to print.</param>
-	void DFA_SET::print(std::vector<DFA_SET*>* dfa) {
-		// errs() << "INSTRUCTION: " << *m_inst << "\n";
+	/// <param name="block">The index of the block to print.</param>
+	void DFA_STATE::print(int block) {
+		// errs() << "BLOCK: " << m_blocks[block]->getName() << "\n";
 		// errs() << "***************** IN\n";
 		// errs() << "{\n";
-		for (auto i = 0; i < m_in.size(); i++) {
-			if (m_in[i]) {
-				// errs() << " " << *((*dfa)[i]->getInstruction()) << "\n";
+		for (auto i = 0; i < numDefinitions(); i++) {
+			if (test(getSet(block, IN), i)) {
+				// errs() << " " << *(m_def_inst[i]) << "\n";
 			}
 		}
 		// errs() << "}\n";
 		// errs() << "**************************************\n";
 		// errs() << "***************** OUT\n";
 		// errs() << "{\n";
-		for (auto i = 0; i < m_out.size(); i++) {
-			if (m_out[i]) {
-				// errs() << " " << *((*dfa)[i]->getInstruction()) << "\n";
+		for (auto i = 0; i < numDefinitions(); i++) {
+			if (test(getSet(block, OUT), i)) {
+				// errs() << " " << *(m_def_inst[i]) << "\n";
 			}
 		}
 		// errs() << "}\n";
@@ -160,65 +436,413 @@ namespace {
 	}
 
 	/// <summary>
-	/// Tests if this instruction defines a CAT variable that escapes.
+	/// A worklist solver for dataflow problems over the reachable BasicBlocks indexed by a DFA_STATE.
+	/// Blocks are visited in reverse post-order for forward problems, and in post-order for backward
+	/// ones, so that (back edges aside) the neighbours a block depends on are final when it is visited.
+	/// A block is only revisited when the output of one of those neighbours changed.
+	/// The problem is a template parameter, so its functions are called directly and can be inlined:
+	/// <para>FORWARD: true if IN is computed from the predecessors, false if OUT is computed from the successors</para>
+	/// <para>void top(int block): starts the input of a block (its IN, or its OUT if backward) at the top of the lattice, or the boundary value</para>
+	/// <para>void meet(int block, int neighbour): meets the input of a block with the output of a predecessor (or successor if backward)</para>
+	/// <para>bool transfer(int block): computes the output of a block from its input, and tests if it changed</para>
+	/// Like DFA_STATE, it is cleared, not freed, between problems.
 	/// </summary>
-	/// <returns>True if this variable has any aliases, false otherwise.</returns>
-	bool DFA_SET::escapes() {
-		return (aliases.find_first() > -1);
-	}
-
-	struct CAT : public FunctionPass {
-		static char ID;
+	struct DFA_SOLVER {
+	public:
+		template <typename PROBLEM>
+		void solve(Function& F, const DFA_STATE& DFA, PROBLEM& problem) {
+			m_order.clear();
+			m_number.resize(DFA.numBlocks());
+			for (auto B : ReversePostOrderTraversal<Function*>(&F)) {
+				m_order.push_back(DFA.getBlockIndex(B));
+			}
+			if (!PROBLEM::FORWARD) {
+				std::reverse(m_order.begin(), m_order.end());
+			}
+			for (auto n = 0; n < m_order.size(); n++) {
+				m_number[m_order[n]] = n;
+			}
 
-		CAT() : FunctionPass(ID) {}
-
-		/// <summary>Tests if an <c>Instruction</c> is killed by another <c>Instruction</c>.</summary>
-		/// <param name='L'>A potentially killed <c>Instruction</c>.</param>
-		/// <param name='R'>An <c>Instruction</c> that may kill <c>L</c>.</param>
-		/// <returns>true if <c>L</c> is killed by <c>R</c>, false otherwise.</returns>
-		bool isKilledBy(const Instruction* L, const Instruction* R) {
-			// Check if R is a call instruction
-			if (auto r_callinst = dyn_cast<CallInst>(R)) {
-				// Return false if R is not a definition of a CAT variable
-				auto f_name = r_callinst->getCalledFunction()->getName();
-				if (!(f_name == "CAT_add" || f_name == "CAT_sub" || f_name == "CAT_set")) { return false; }
-				// Get the Instruction at the first operand of R
-				auto r_operand = r_callinst->getArgOperand(0);
-				// Test if L is the same Instruction as the first operand of R
-				if (L == r_operand) {
-					return true;
+			// Worklist of positions in m_order
+			m_worklist.clear();
+			m_worklist.resize(m_order.size(), true);
+			m_visits = 0;
+			m_sweeps = 1;
+			m_changed_sweep = 0;
+			int next{ m_worklist.find_first() };
+			while (next != -1) {
+				m_worklist.reset(next);
+				auto block{ m_order[next] };
+				auto B{ DFA.getBlock(block) };
+				m_visits++;
+				problem.top(block);
+				if (PROBLEM::FORWARD) {
+					for (auto P : predecessors(B)) {
+						// Predecessors in unreachable code have no DFA
+						auto pred{ DFA.getBlockIndex(P) };
+						if (pred != -1) { problem.meet(block, pred); }
+					}
 				}
-				// Check if L is a call instruction
-				if (auto l_callinst = dyn_cast<CallInst>(L)) {
-					// Return false if L is not a definition of a CAT variable
-					f_name = l_callinst->getCalledFunction()->getName();
-					if (!(f_name == "CAT_add" || f_name == "CAT_sub" || f_name == "CAT_set")) { return false; }
-					// Get the Instruction at the first operand of L
-					if (auto l_operand = dyn_cast<CallInst>(l_callinst->getArgOperand(0))) {
-						// Test if the first operand of L is the same Instruction as the first operand of R
-						if (l_operand == r_operand) {
-							return true;
+				else {
+					for (auto S : successors(B)) {
+						problem.meet(block, DFA.getBlockIndex(S));
+					}
+				}
+				// Only the neighbours depending on a block whose output changed need to be revisited
+				if (problem.transfer(block)) {
+					m_changed_sweep = m_sweeps;
+					if (PROBLEM::FORWARD) {
+						for (auto S : successors(B)) {
+							m_worklist.set(m_number[DFA.getBlockIndex(S)]);
+						}
+					}
+					else {
+						for (auto P : predecessors(B)) {
+							auto pred{ DFA.getBlockIndex(P) };
+							if (pred != -1) { m_worklist.set(m_number[pred]); }
 						}
 					}
 				}
+
+				// Continue the current sweep, or wrap around to start another one
+				auto following{ m_worklist.find_next(next) };
+				if (following == -1) {
+					following = m_worklist.find_first();
+					if (following != -1) { m_sweeps++; }
+				}
+				next = following;
+			}
+		}
+
+		/// The number of blocks visited by the last solve()
+		int getVisits() const {
+			return m_visits;
+		}
+		/// The number of sweeps over the blocks made by the last solve()
+		int getSweeps() const {
+			return m_sweeps;
+		}
+		/// The number of sweeps over every block a round-robin solver visiting the blocks in the same
+		/// order would make: up to the last sweep in which an output changed, then one to see nothing did
+		int getRoundRobinSweeps() const {
+			return m_changed_sweep + 1;
+		}
+	private:
+		// Blocks in visiting order, and the position of each block in it
+		std::vector<int> m_order;
+		std::vector<int> m_number;
+		BitVector m_worklist;
+		int m_visits{ 0 };
+		int m_sweeps{ 0 };
+		int m_changed_sweep{ 0 };
+	};
+
+	/// <summary>
+	/// Reaching definitions on the SETs of a DFA_STATE:
+	/// <para>IN = U OUT of the predecessors, OUT = GEN U (IN - KILL)</para>
+	/// </summary>
+	struct REACHING_DEFINITIONS {
+		const static bool FORWARD{ true };
+		DFA_STATE& DFA;
+		// Scratch SET for the new OUT SET
+		DFA_STATE::Word* out;
+
+		void top(int block) {
+			DFA.clear(DFA.getSet(block, DFA_STATE::IN));
+		}
+		void meet(int block, int pred) {
+			DFA.merge(DFA.getSet(block, DFA_STATE::IN), DFA.getSet(pred, DFA_STATE::OUT));
+		}
+		bool transfer(int block) {
+			DFA.copy(out, DFA.getSet(block, DFA_STATE::IN));
+			DFA.transfer(out, block);
+			if (DFA.equals(out, DFA.getSet(block, DFA_STATE::OUT))) { return false; }
+			DFA.copy(DFA.getSet(block, DFA_STATE::OUT), out);
+			return true;
+		}
+	};
+
+	/// <summary>
+	/// A GEN/KILL problem on one BitVector per block for each of its sets, in either direction,
+	/// with union (may) or intersection (must) as the meet:
+	/// <para>input = meet of the outputs of the neighbours, output = GEN U (input - KILL)</para>
+	/// The input of the boundary block starts empty; for intersection, the other inputs start full.
+	/// </summary>
+	template <bool Forward, bool Intersect>
+	struct GEN_KILL_PROBLEM {
+		const static bool FORWARD{ Forward };
+		std::vector<BitVector>& input;
+		std::vector<BitVector>& output;
+		std::vector<BitVector>& gen;
+		std::vector<BitVector>& kill;
+		// The block without any neighbour to meet, or -1
+		int boundary;
+		BitVector scratch;
+
+		void top(int block) {
+			if (Intersect && block != boundary) { input[block].set(); }
+			else { input[block].reset(); }
+		}
+		void meet(int block, int neighbour) {
+			if (Intersect) { input[block] &= output[neighbour]; }
+			else { input[block] |= output[neighbour]; }
+		}
+		bool transfer(int block) {
+			scratch = input[block];
+			scratch.reset(kill[block]);
+			scratch |= gen[block];
+			if (scratch == output[block]) { return false; }
+			output[block] = scratch;
+			return true;
+		}
+	};
+
+	/// <summary>
+	/// The value of a definition in the constant propagation lattice:
+	/// <para>UNKNOWN: no value is known yet</para>
+	/// <para>CONSTANT: always the same constant</para>
+	/// <para>NONCONSTANT: may be more than one value</para>
+	/// </summary>
+	struct LATTICE_VALUE {
+	public:
+		enum State { UNKNOWN, CONSTANT, NONCONSTANT };
+
+		LATTICE_VALUE() {}
+		LATTICE_VALUE(ConstantInt* c) : m_state(c == nullptr ? NONCONSTANT : CONSTANT), m_value(c) {}
+
+		State getState() const {
+			return m_state;
+		}
+		bool isConstant() const {
+			return m_state == CONSTANT;
+		}
+		ConstantInt* getConstant() const {
+			return m_value;
+		}
+
+		/// <summary>Lowers this value to the meet of itself and another value.</summary>
+		/// <param name='other'>The value to meet with.</param>
+		/// <returns>true if this value changed, false otherwise.</returns>
+		bool meet(const LATTICE_VALUE& other) {
+			if (other.m_state == UNKNOWN || m_state == NONCONSTANT) { return false; }
+			if (m_state == UNKNOWN) {
+				*this = other;
+				return true;
+			}
+			if (other.m_state == NONCONSTANT || m_value->getSExtValue() != other.m_value->getSExtValue()) {
+				m_state = NONCONSTANT;
+				m_value = nullptr;
+				return true;
 			}
 			return false;
 		}
+	private:
+		State m_state{ UNKNOWN };
+		ConstantInt* m_value{ nullptr };
+	};
+
+	/// <summary>
+	/// A read of a version of a CAT variable by the SCCP engine: by a CAT API call, or along
+	/// one incoming edge of a PHI of CAT variables or of a virtual PHI.
+	/// </summary>
+	struct SCCP_USE {
+		// The version read, -1 if no definition of the CAT variable reaches
+		int version;
+		// The Instruction reading it, or nullptr for a virtual PHI
+		Instruction* inst;
+		// The virtual PHI reading it
+		int vphi;
+	};
+
+	/// <summary>
+	/// This struct holds the state of the sparse conditional constant propagation engine.
+	/// Every definition of a CAT variable is a version of that variable, as in SSA form,
+	/// and a virtual PHI is placed wherever different versions of a CAT variable merge.
+	/// Versions 0 ... (definitions - 1) are the definitions, the virtual PHIs follow.
+	/// Like DFA_STATE, it is cleared, not freed, between functions.
+	/// </summary>
+	struct SCCP_STATE {
+	public:
+		void clear() {
+			frontier.clear();
+			frontier_begin.clear();
+			placed.clear();
+			queued.clear();
+			blocks.clear();
+			placement.clear();
+			vphi_var.clear();
+			vphi_block.clear();
+			vphi_begin.clear();
+			uses.clear();
+			vphi_use.clear();
+			use_index.clear();
+			user_begin.clear();
+			user_list.clear();
+			current.clear();
+			undo.clear();
+			values.clear();
+			executable.clear();
+			executable_edges.clear();
+			inst_worklist.clear();
+			vphi_worklist.clear();
+		}
+
+		// Dominance frontiers as (block, join block) edges; those of block b start at frontier_begin[b]
+		std::vector<std::pair<int, int>> frontier;
+		std::vector<int> frontier_begin;
+		// The last CAT variable given a virtual PHI in, or queued from, each block, and the blocks queued
+		std::vector<int> placed;
+		std::vector<int> queued;
+		std::vector<int> blocks;
+		// (block, CAT variable) of every virtual PHI, before they are sorted by block
+		std::vector<std::pair<int, int>> placement;
+		// Virtual PHIs; those of block b are vphi_begin[b] ... vphi_begin[b + 1] - 1
+		std::vector<int> vphi_var;
+		std::vector<int> vphi_block;
+		std::vector<int> vphi_begin;
+		// Reads; those of virtual PHI k start at vphi_use[k], one per predecessor,
+		// and those of an Instruction start at use_index[I], one per CAT variable read
+		std::vector<SCCP_USE> uses;
+		std::vector<int> vphi_use;
+		DenseMap<const Instruction*, int> use_index;
+		// The reads of version v are user_list[user_begin[v] ... user_begin[v + 1] - 1]
+		std::vector<int> user_begin;
+		std::vector<int> user_list;
+		// Renaming: the version of each CAT variable at the current point, and the versions to restore
+		std::vector<int> current;
+		std::vector<std::pair<int, int>> undo;
+		// The lattice value of each integer Instruction
+		DenseMap<const Instruction*, LATTICE_VALUE> values;
+		// Executable blocks and CFG edges
+		BitVector executable;
+		DenseSet<std::pair<const BasicBlock*, const BasicBlock*>> executable_edges;
+		// Instructions and virtual PHIs to (re)visit
+		std::vector<Instruction*> inst_worklist;
+		std::vector<int> vphi_worklist;
+	};
+
+	/// <summary>
+	/// This struct holds the reaching definitions of each CAT variable solved on its own. CAT variables
+	/// never interact, so the definitions of a CAT variable can be solved as a slice of the universe,
+	/// with SETs only as wide as its number of definitions, and only over the blocks they reach.
+	/// Bit k of a slice is the k-th definition of the CAT variable in program order.
+	/// Like DFA_STATE, it is cleared, not freed, between functions.
+	/// </summary>
+	struct SLICE_STATE {
+	public:
+		void clear() {
+			words.clear();
+			row_index.clear();
+			worklist.clear();
+			current.clear();
+			touched.clear();
+		}
+
+		// The IN and OUT SETs of a CAT variable in a block are the rows at row_index[(variable, block)]
+		// of the arena, followed by each other; blocks no definition of the CAT variable reaches have none
+		std::vector<DFA_STATE::Word> words;
+		DenseMap<std::pair<int, int>, int> row_index;
+		// Solving one CAT variable: the bit of the last definition in each block, or -1, and the blocks to visit
+		std::vector<int> gen;
+		std::vector<int> worklist;
+		BitVector queued;
+		// Pass 3: the last definition of each CAT variable in the block scanned so far, or -1, and the CAT variables set
+		std::vector<int> current;
+		std::vector<int> touched;
+	};
+
+	/// <summary>
+	/// This struct holds the CAT API functions a module declares, and the functions of the
+	/// module that call them. It is shared by the analyses of every function of the module,
+	/// and only <c>declare</c> changes it, so functions can be analyzed concurrently.
+	/// </summary>
+	struct CAT_MODULE {
+	public:
+		/// <summary>Classifies the CAT API functions a module declares, and finds the functions calling them.</summary>
+		/// <param name='M'>The module.</param>
+		/// <param name='callers'>Whether to find the functions calling the CAT API, a walk over every CAT API call of the module.</param>
+		void initialize(Module& M, bool callers = true) {
+			mod = &M; // save the module
+			// Classify the CAT API functions once, instead of comparing names at every call
+			api.clear();
+			// Only functions calling the CAT API can have anything to propagate or fold,
+			// and the use-lists of the CAT API declarations tell us which functions those are
+			cat_functions.clear();
+			for (auto op = 0; op < CAT_API::API.size(); op++) {
+				if (auto f = M.getFunction(CAT_API::API[op])) {
+					api[f] = (CAT_API::Opcode)op;
+					if (!callers) { continue; }
+					for (auto user : f->users()) {
+						if (auto callInst = dyn_cast<CallInst>(user)) {
+							cat_functions.insert(callInst->getFunction());
+						}
+					}
+				}
+			}
+		}
+
+		/// <summary>Classifies a call by the function it calls.</summary>
+		/// <param name='callInst'>The call to classify.</param>
+		/// <returns>The opcode of the CAT API function called, or <c>CALL</c> for any other (or an indirect) call.</returns>
+		CAT_API::Opcode classify(const CallInst* callInst) const {
+			auto f{ callInst->getCalledFunction() };
+			if (f == nullptr) { return CAT_API::CALL; }
+			auto iter{ api.find(f) };
+			return iter == api.end() ? CAT_API::CALL : iter->second;
+		}
+
+		/// <summary>Gets the declaration of a CAT API function, declaring it if the module does not yet.</summary>
+		/// <param name='op'>The opcode of the function, <c>GET</c> or <c>SET</c>.</param>
+		/// <param name='ctx'>The context of the module.</param>
+		/// <returns>The function to call.</returns>
+		FunctionCallee declare(CAT_API::Opcode op, LLVMContext& ctx) {
+			auto catType{ PointerType::get(IntegerType::get(ctx, 8), 0) };
+			auto intType{ IntegerType::get(ctx, 64) };
+			FunctionCallee f{ op == CAT_API::GET ?
+				mod->getOrInsertFunction(CAT_API::API[op], intType, catType) :
+				mod->getOrInsertFunction(CAT_API::API[op], Type::getVoidTy(ctx), catType, intType)
+			};
+			// The function may not have been declared before
+			if (auto function = dyn_cast<Function>(f.getCallee())) {
+				api.insert(std::make_pair(function, op));
+			}
+			return f;
+		}
+
+		// The functions of the module that call the CAT API
+		SmallPtrSet<const Function*, 16> cat_functions;
+
+	private:
+		// A pointer to the Module for use in IR building
+		Module* mod{ nullptr };
+		// The opcode of each CAT API function declared in the module
+		DenseMap<const Function*, CAT_API::Opcode> api;
+	};
+
+	/// <summary>
+	/// This struct holds the analyses and transformations of the CAT pass for one function at a time.
+	/// <c>analyze</c> only reads the IR, so several instances may analyze different functions of
+	/// a module at once; <c>presimplify</c> and <c>transform</c> rewrite it.
+	/// </summary>
+	struct CAT_FUNCTION {
+	public:
+		CAT_FUNCTION(CAT_MODULE& module) : module(module) {}
 
 		/// <summary>
 		/// Tests if an <c>Instruction</c> (re)defines a <c>Value</c> to a constant value.
 		/// Pass the same value as both parameters to check if an Instruction defines a constant value.
+		/// PHIs are not handled here, their values depend on the IN/OUT SETs and are solved by <c>computeConstants</c>.
 		/// </summary>
 		/// <param name='L'>A potential definition <c>Instruction</c>.</param>
 		/// <param name='R'>A <c>Value</c> to be tested.</param>
-		/// <returns>A pointer to the value <c>R</c> is set to, or <c>nullptr</c> if <c>L</c> does not (re)define <c>R</c>.</returns>
-		ConstantInt* definesAsConstant(const Instruction* L, const Value* R, const PHINode* originalPhi = nullptr) {
+		/// <returns>A pointer to the value <c>R</c> is set to, or <c>nullptr</c> if <c>L</c> does not (re)define <c>R</c> to a constant.</returns>
+		ConstantInt* definesAsConstant(const Instruction* L, const Value* R) {
 			// Try to cast L to a CAT API call
 			if (auto callInst = dyn_cast<CallInst>(L)) {
 				// Initial definition of a CAT variable
 				//  %1 = tail call i8* @CAT_new(i64 5) #3
 				if (
-					callInst->getCalledFunction()->getName() == "CAT_new" &&
+					classify(callInst) == CAT_API::NEW &&
 					callInst == R &&
 					isa<ConstantInt>(callInst->getArgOperand(0))
 					) {
@@ -227,52 +851,205 @@ namespace {
 				// Redefinition of a CAT variable
 				//  tail call void @CAT_set(i8* %1, i64 42) #3
 				if (
-					callInst->getCalledFunction()->getName() == "CAT_set" &&
+					classify(callInst) == CAT_API::SET &&
 					callInst->getArgOperand(0) == R &&
 					isa<ConstantInt>(callInst->getArgOperand(1))
 					) {
 					return cast<ConstantInt>(callInst->getArgOperand(1));
 				}
 			}
-			if (auto phiInst = dyn_cast<PHINode>(L)) {
-				// Prevent infinite recursion: if we've already come across this Phi node then break out
-				if (phiInst == originalPhi) { return nullptr; }
-				// errs() << "[PHI: " << phiInst->getNumIncomingValues() << "] ";
-				bool all_consts{ true };
-				bool val_set{ false };
-				ConstantInt* val = nullptr;
-				// Check each incoming value
-				for (auto i = 0; i < phiInst->getNumIncomingValues(); i++) {
-					if (auto incomingInst = dyn_cast<Instruction>(phiInst->getIncomingValue(i))) {
-						// If each incoming value defines R as a constant, we're set to return that constant
-						if (auto c = definesAsConstant(incomingInst, incomingInst, (originalPhi == nullptr ? phiInst : originalPhi))) {
-							if (!val_set) {
-								val_set = true;
-								val = c;
-							}
-							else if (val->getSExtValue() != c->getSExtValue()) {
-								all_consts = false;
-								goto DEF_CONST;
-							}
+			return nullptr;
+		}
+
+		/// <summary>
+		/// Computes the lattice value of every definition once, so that constant propagation
+		/// only has to read them. A PHI's value is the meet, over its incoming edges, of the
+		/// values of the definitions of the incoming CAT variable that reach the end of the
+		/// incoming block. PHIs start out UNKNOWN and are lowered until nothing changes, so
+		/// cycles of PHIs are resolved optimistically; each PHI is only revisited when one
+		/// of its incoming PHIs changes.
+		/// </summary>
+		void computeConstants() {
+			constants.assign(DFA.numDefinitions(), LATTICE_VALUE());
+			phi_worklist.clear();
+			phi_queued.clear();
+			phi_queued.resize(DFA.numDefinitions());
+			for (auto i = DFA.numDefinitions() - 1; i >= 0; i--) {
+				if (isa<PHINode>(DFA.getInstruction(i))) {
+					phi_worklist.push_back(i);
+					phi_queued.set(i);
+				}
+				else {
+					constants[i] = LATTICE_VALUE(definesAsConstant(DFA.getInstruction(i), DFA.getVariable(i)));
+				}
+			}
+			solvePhis();
+		}
+
+		/// <summary>
+		/// Lowers the value of the PHI definitions in the worklist, and of the PHIs using them,
+		/// until nothing changes, then gives any PHI left UNKNOWN its NONCONSTANT value.
+		/// </summary>
+		void solvePhis() {
+			while (!phi_worklist.empty()) {
+				auto i{ phi_worklist.back() };
+				phi_worklist.pop_back();
+				phi_queued.reset(i);
+				auto phiInst{ cast<PHINode>(DFA.getInstruction(i)) };
+				LATTICE_VALUE value;
+				for (auto j = 0; j < phiInst->getNumIncomingValues(); j++) {
+					// Edges from unreachable code are never taken
+					auto pred{ DFA.getBlockIndex(phiInst->getIncomingBlock(j)) };
+					if (pred == -1) { continue; }
+					value.meet(valueAtEnd(pred, phiInst->getIncomingValue(j)));
+				}
+				if (value.getState() == constants[i].getState()) { continue; }
+				constants[i] = value;
+				// Only PHIs using this PHI as an incoming value depend on it
+				for (auto user : phiInst->users()) {
+					auto userPhi{ dyn_cast<PHINode>(user) };
+					if (userPhi == nullptr) { continue; }
+					auto j{ DFA.getDefinition(userPhi) };
+					if (j != -1 && !phi_queued.test(j)) {
+						phi_worklist.push_back(j);
+						phi_queued.set(j);
+					}
+				}
+			}
+			// Anything still unknown was never given a value
+			for (auto& value : constants) {
+				if (value.getState() == LATTICE_VALUE::UNKNOWN) {
+					value = LATTICE_VALUE(nullptr);
+				}
+			}
+		}
+
+		/// <summary>Computes the value of a CAT variable from the definitions in a SET.</summary>
+		/// <param name='s'>The SET of reaching definitions.</param>
+		/// <param name='V'>The CAT variable.</param>
+		/// <returns>The meet of the values of every definition of <c>V</c> in <c>s</c>, NONCONSTANT if there are none.</returns>
+		LATTICE_VALUE valueOf(const DFA_STATE::Word* s, const Value* V) {
+			LATTICE_VALUE value;
+			bool reached{ false };
+			for (auto i : DFA.getDefinitions(V)) {
+				if (!DFA.test(s, i)) { continue; }
+				// errs() << ">" << *(DFA.getInstruction(i)) << "\n";
+				reached = true;
+				value.meet(constants[i]);
+			}
+			return reached ? value : LATTICE_VALUE(nullptr);
+		}
+
+		/// <summary>Computes the value of a CAT variable from the definitions in a slice of it.</summary>
+		/// <param name='row'>The slice of the reaching definitions of the CAT variable.</param>
+		/// <param name='var'>The index of the CAT variable.</param>
+		/// <returns>The meet of the values of the definitions in <c>row</c>, NONCONSTANT if there are none.</returns>
+		LATTICE_VALUE valueOf(const DFA_STATE::Word* row, int var) {
+			LATTICE_VALUE value;
+			bool reached{ false };
+			auto defs{ DFA.getVariableDefinitions(var) };
+			for (auto k = 0; k < defs.size(); k++) {
+				if (!DFA.test(row, k)) { continue; }
+				reached = true;
+				value.meet(constants[defs[k]]);
+			}
+			return reached ? value : LATTICE_VALUE(nullptr);
+		}
+
+		/// <summary>Computes the value of a CAT variable at the end of a block, from its OUT SET or its slice.</summary>
+		LATTICE_VALUE valueAtEnd(int block, const Value* V) {
+			if (!UseSlices) {
+				return valueOf(DFA.getSet(block, DFA_STATE::OUT), V);
+			}
+			auto var{ DFA.getVariableIndex(V) };
+			if (var == -1) { return LATTICE_VALUE(nullptr); }
+			auto iter{ SLICES.row_index.find(std::make_pair(var, block)) };
+			if (iter == SLICES.row_index.end()) { return LATTICE_VALUE(nullptr); }
+			auto words{ ((int)DFA.getVariableDefinitions(var).size() + 63) / 64 };
+			return valueOf(&SLICES.words[iter->second + words], var);
+		}
+
+		/// <summary>
+		/// Computes the value of a CAT variable read during Pass 3, from the IN SET of the read, or
+		/// from the last definition of the CAT variable before it in its block, or else from its slice.
+		/// </summary>
+		LATTICE_VALUE valueAtRead(const DFA_STATE::Word* in, int block, const Value* V) {
+			if (!UseSlices) {
+				return valueOf(in, V);
+			}
+			auto var{ DFA.getVariableIndex(V) };
+			if (var == -1) { return LATTICE_VALUE(nullptr); }
+			if (SLICES.current[var] != -1) { return constants[SLICES.current[var]]; }
+			auto iter{ SLICES.row_index.find(std::make_pair(var, block)) };
+			if (iter == SLICES.row_index.end()) { return LATTICE_VALUE(nullptr); }
+			return valueOf(&SLICES.words[iter->second], var);
+		}
+
+		/// <summary>
+		/// Solves the reaching definitions of each CAT variable separately. Starting from the blocks
+		/// defining the CAT variable, a block is only visited when the OUT SET of one of its
+		/// predecessors changed, so blocks its definitions never reach are never visited:
+		/// <para>IN = U OUT of the predecessors, OUT = the last definition in the block if any, IN otherwise</para>
+		/// </summary>
+		void solveSlices() {
+			SLICES.clear();
+			SLICES.gen.assign(DFA.numBlocks(), -1);
+			SLICES.queued.clear();
+			SLICES.queued.resize(DFA.numBlocks());
+			SLICES.current.assign(DFA.numVariables(), -1);
+			for (auto var = 0; var < DFA.numVariables(); var++) {
+				auto defs{ DFA.getVariableDefinitions(var) };
+				auto words{ ((int)defs.size() + 63) / 64 };
+				for (auto k = 0; k < defs.size(); k++) {
+					auto block{ DFA.getBlockIndex(DFA.getInstruction(defs[k])->getParent()) };
+					if (SLICES.gen[block] == -1) {
+						SLICES.worklist.push_back(block);
+						SLICES.queued.set(block);
+					}
+					SLICES.gen[block] = k;
+				}
+				while (!SLICES.worklist.empty()) {
+					auto block{ SLICES.worklist.back() };
+					SLICES.worklist.pop_back();
+					SLICES.queued.reset(block);
+					NumSliceVisits++;
+					auto row_iter{ SLICES.row_index.insert(std::make_pair(std::make_pair(var, block), (int)SLICES.words.size())) };
+					auto row{ row_iter.first->second };
+					if (row_iter.second) { SLICES.words.resize(SLICES.words.size() + 2 * words, 0); }
+					auto in{ &SLICES.words[row] };
+					auto out{ in + words };
+					std::fill(in, in + words, 0);
+					for (auto P : predecessors(DFA.getBlock(block))) {
+						auto pred_iter{ SLICES.row_index.find(std::make_pair(var, DFA.getBlockIndex(P))) };
+						if (pred_iter == SLICES.row_index.end()) { continue; }
+						auto pred_out{ &SLICES.words[pred_iter->second + words] };
+						for (auto w = 0; w < words; w++) {
+							in[w] |= pred_out[w];
 						}
-						else {
-							all_consts = false;
-							goto DEF_CONST;
+					}
+					auto changed{ false };
+					for (auto w = 0; w < words; w++) {
+						auto word{ in[w] };
+						if (SLICES.gen[block] != -1) {
+							word = SLICES.gen[block] / 64 == w ? DFA_STATE::Word(1) << (SLICES.gen[block] % 64) : 0;
 						}
+						changed |= word != out[w];
+						out[w] = word;
 					}
-					else {
-						// An incoming value was not a CAT variable
-						all_consts = false;
+					// The definitions of a block reach its successors the first time it is visited
+					if (!changed && !(row_iter.second && SLICES.gen[block] != -1)) { continue; }
+					for (auto S : successors(DFA.getBlock(block))) {
+						auto succ{ DFA.getBlockIndex(S) };
+						if (!SLICES.queued.test(succ)) {
+							SLICES.worklist.push_back(succ);
+							SLICES.queued.set(succ);
+						}
 					}
 				}
-				// We can return val if all_consts is set, because either ALL
-				// incoming values defined R as a constant, or NONE of them did
-			DEF_CONST:
-				if (all_consts) {
-					return val;
+				for (auto def : defs) {
+					SLICES.gen[DFA.getBlockIndex(DFA.getInstruction(def)->getParent())] = -1;
 				}
 			}
-			return nullptr;
 		}
 
 		/// <summary>Tests if an <c>Instruction</c> (re)defines a <c>Value</c>.</summary>
@@ -282,20 +1059,20 @@ namespace {
 		bool defines(const Instruction* L, const Value* R, AAResults& AA) {
 			// Try to cast L to a CAT API call
 			if (auto callInst = dyn_cast<CallInst>(L)) {
-				auto f_name = callInst->getCalledFunction()->getName();
+				auto op = classify(callInst);
 				// Initial definition of a CAT variable
 				//  %1 = tail call i8* @CAT_new(i64 5) #3
-				if (f_name == "CAT_new") {
+				if (op == CAT_API::NEW) {
 					return (callInst == R);
 				}
 				// Redefinitions of a CAT variable
 				//  tail call void @CAT_set(i8* %1, i64 42) #3
 				//  tail call void @CAT_add(i8* %3, i8* %3, i8* %3) #3
-				if (f_name == "CAT_set" || f_name == "CAT_add" || f_name == "CAT_sub") {
+				if (op == CAT_API::SET || op == CAT_API::ADD || op == CAT_API::SUB) {
 					return (callInst->getArgOperand(0) == R);
 				}
 				// Reading a CAT variable does NOT redefine it
-				if (f_name == "CAT_get") {
+				if (op == CAT_API::GET) {
 					return false;
 				}
 				// Any other function MAY redefine a CAT variable
@@ -303,7 +1080,7 @@ namespace {
 				// Thus we must check all non-CAT API calls' args for CAT variables 
 				for (auto i = 0; i < callInst->getNumArgOperands(); i++) {
 					if (callInst->getArgOperand(i) == R) {
-						return mods(AA.getModRefInfo(L, R, 8));
+						return mods(getModRefInfo(callInst, R, AA));
 					}
 				}
 			}
@@ -313,11 +1090,19 @@ namespace {
 			return false;
 		}
 
-		// This function is invoked once at the initialization phase of the compiler
-		// The LLVM IR of functions isn't ready at this point
-		bool doInitialization(Module& M) override {
-			mod = &M; // save the module
-			return false;
+		/// <summary>Classifies a call by the function it calls.</summary>
+		/// <param name='callInst'>The call to classify.</param>
+		/// <returns>The opcode of the CAT API function called, or <c>CALL</c> for any other (or an indirect) call.</returns>
+		CAT_API::Opcode classify(const CallInst* callInst) const {
+			return module.classify(callInst);
+		}
+
+		/// <summary>Gets the declaration of a CAT API function, declaring it if the module does not yet.</summary>
+		/// <param name='op'>The opcode of the function, <c>GET</c> or <c>SET</c>.</param>
+		/// <param name='ctx'>The context of the module.</param>
+		/// <returns>The function to call.</returns>
+		FunctionCallee declare(CAT_API::Opcode op, LLVMContext& ctx) {
+			return module.declare(op, ctx);
 		}
 
 		void printModRefInfo(ModRefInfo mr) {
@@ -347,6 +1132,26 @@ namespace {
 			// errs() << "\n";
 		}
 
+		/// <summary>
+		/// Asks alias analysis whether a call may modify or read a CAT variable, at most once
+		/// per call and CAT variable of the current function.
+		/// </summary>
+		/// <param name='callInst'>The call.</param>
+		/// <param name='V'>The CAT variable.</param>
+		/// <returns>The mod/ref behaviour of <c>callInst</c> on the CAT variable.</returns>
+		ModRefInfo getModRefInfo(const CallInst* callInst, const Value* V, AAResults& AA) {
+			auto iter{ modref_cache.find(std::make_pair(callInst, V)) };
+			if (iter != modref_cache.end()) {
+				NumModRefCacheHits++;
+				return iter->second;
+			}
+			NumModRefQueries++;
+			auto mr = AA.getModRefInfo(callInst, V, 8);
+			printModRefInfo(mr);
+			modref_cache[std::make_pair(callInst, V)] = mr;
+			return mr;
+		}
+
 		bool mods(ModRefInfo mr) {
 			switch (mr) {
 			case ModRefInfo::ModRef:
@@ -377,345 +1182,2301 @@ namespace {
 			}
 		}
 
-		// This function is invoked once per function compiled
-		// The LLVM IR of the input functions is ready and it can be analyzed and/or transformed
-		bool runOnFunction(Function& F) override {
+		/// <summary>Solves the reaching definitions of all CAT variables at once, over every block.</summary>
+		void solveBlocks(Function& F) {
+			// Fold each BasicBlock's definitions into a single block-level transfer function
+			// so that the fixpoint below iterates over blocks instead of Instructions
+			DFA.initSets();
+
+			// Visit blocks in reverse post-order; a block is only revisited when the OUT set
+			// of one of its predecessors has changed
+			REACHING_DEFINITIONS problem{ DFA, DFA.getScratch(0) };
+			solver.solve(F, DFA, problem);
+			auto visits{ solver.getVisits() };
+			auto numBlocks{ DFA.numBlocks() };
+			// The worklist only did (visits / blocks) sweeps worth of work
+			auto sweeps{ (visits + numBlocks - 1) / numBlocks };
+			NumBlockVisits += visits;
+			NumSweepsSaved += std::max(0, solver.getRoundRobinSweeps() - sweeps);
+		}
+
+		/// <summary>Records the constant propagation or folding a CAT API call allows (Pass 3).</summary>
+		/// <param name='callInst'>The call.</param>
+		/// <param name='valueOf'>Computes the value of a CAT variable where the call reads it.</param>
+		template <typename ValueOf>
+		void examine(CallInst* callInst, ValueOf valueOf) {
+			auto op{ classify(callInst) };
+			/* Constant Propagation */
+			// We're only interested in calls to CAT_get, since that can be converted to a constant int
+			if (op == CAT_API::GET) {
+				// All reaching definitions of the CAT variable must be the same constant
+				auto value{ valueOf(callInst->getArgOperand(0)) };
+				if (value.isConstant()) {
+					propagations.push_back(std::pair<Instruction*, Value*>(callInst, value.getConstant()));
+				}
+			}
+			/* Constant Folding */
+			// We're only interested in calls to CAT_add and CAT_sub, since those can be converted to CAT_set
+			else if (op == CAT_API::ADD || op == CAT_API::SUB) {
+				// Both arguments 1 and 2 must be constants
+				auto value1{ valueOf(callInst->getArgOperand(1)) };
+				auto value2{ valueOf(callInst->getArgOperand(2)) };
+				if (value1.isConstant() && value2.isConstant()) {
+					int val1 = value1.getConstant()->getSExtValue();
+					int val2 = value2.getConstant()->getSExtValue();
+					// errs() << "> Folding to " << "CAT_set(" << (op == CAT_API::ADD ? val1 + val2 : val1 - val2) << ")\n";
+					foldings.push_back(std::pair<Instruction*, int64_t>(callInst, (op == CAT_API::ADD ? val1 + val2 : val1 - val2)));
+				}
+				else if (UseSimplification) {
+					addSimplification(callInst, value1, value2);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Updates the values of the definitions changed by the last rewrites, then lowers the PHIs
+		/// depending on them from UNKNOWN again, and finds the propagations and foldings the new
+		/// values allow. Rewrites only ever turn a NONCONSTANT definition into a constant one and
+		/// never add or remove a definition, so the IN/OUT SETs stay as they are, and only the
+		/// reads of a CAT variable with a changed definition, or of such a PHI, can see a new value.
+		/// </summary>
+		/// <param name='changed'>The definitions whose Instruction was rewritten or given a constant operand.</param>
+		void reexamine(ArrayRef<int> changed) {
+			propagations.clear();
+			foldings.clear();
+			SmallSetVector<Value*, 16> affected;
+			for (auto def : changed) {
+				constants[def] = LATTICE_VALUE(definesAsConstant(DFA.getInstruction(def), DFA.getVariable(def)));
+				affected.insert(DFA.getVariable(def));
+			}
+			for (auto k = 0; k < affected.size(); k++) {
+				for (auto user : affected[k]->users()) {
+					auto phiInst{ dyn_cast<PHINode>(user) };
+					if (phiInst == nullptr) { continue; }
+					auto def{ DFA.getDefinition(phiInst) };
+					if (def == -1 || !affected.insert(phiInst)) { continue; }
+					constants[def] = LATTICE_VALUE();
+					phi_worklist.push_back(def);
+					phi_queued.set(def);
+				}
+			}
+			solvePhis();
+			SmallPtrSet<const CallInst*, 16> examined;
+			for (auto V : affected) {
+				for (auto user : V->users()) {
+					auto callInst{ dyn_cast<CallInst>(user) };
+					if (callInst == nullptr) { continue; }
+					auto op{ classify(callInst) };
+					auto reads{ (op == CAT_API::GET && callInst->getArgOperand(0) == V) ||
+						((op == CAT_API::ADD || op == CAT_API::SUB) &&
+						(callInst->getArgOperand(1) == V || callInst->getArgOperand(2) == V)) };
+					if (reads && examined.insert(callInst).second) {
+						examine(callInst, [&](const Value* R) { return valueAt(R, callInst); });
+					}
+				}
+			}
+		}
+
+		/// <summary>Applies the constant propagations and foldings found.</summary>
+		/// <param name='ctx'>The context of the function.</param>
+		/// <param name='changed'>If not <c>nullptr</c>, where to add the definitions whose value the rewrites may change.</param>
+		/// <returns>Whether anything was rewritten.</returns>
+		bool applyRewrites(LLVMContext& ctx, SmallVectorImpl<int>* changed) {
 			// Used to keep track of whether our pass has modified anything
 			bool has_modified_code{ false };
-			// Used to check for unreachable code
-			DominatorTree& DT{ getAnalysis<DominatorTreeWrapperPass>().getDomTree() };
-			AAResults& AA{ getAnalysis<AAResultsWrapperPass>().getAAResults() };
-			// Used to hold GEN/KILL/IN/OUT SETs for each Instruction
-			std::vector<DFA_SET*> DFA;
-
-			// Reusable index variable
-			auto index{ 0 };
-			// Reusable context variable
-			auto& ctx{ F.getContext() };
-
-			/* Pass 1: GEN/KILL */
-			for (auto& B : F) {
-				// Skip unreachable code
-				if (DT.getNode(&B) == NULL) { continue; }
 
-				for (auto& I : B) {
-					DFA_SET* p_dfa{ new DFA_SET(&I) };
-					// errs() << index << ": " << *(p_dfa->getInstruction()) << "\n";
-					p_dfa->add(index, DFA_SET::GEN);
-					if (auto callInst = dyn_cast<CallInst>(&I)) {
-						// Check all CAT API functions except CAT_get, as these calls define CAT variables
-						auto cat_iter{ find(CAT_API::API.begin(), CAT_API::API.end(), callInst->getCalledFunction()->getName()) };
-						if (cat_iter != CAT_API::API.end() && *cat_iter != "CAT_get") {
-							// Look for any other instructions this one KILLs (and other instructions that KILL this one)
-							for (auto i = 0; i < index; i++) {
-								if (isKilledBy(DFA[i]->getInstruction(), callInst)) {
-									DFA[i]->add(index, DFA_SET::KILL);
-									p_dfa->add(i, DFA_SET::KILL);
-									// errs() << *callInst << " < kills > " << *(DFA[i]->getInstruction()) << "\n";
-								}
-							}
-						}
-						// Check if a non-CAT API function kills a CAT variable
-						else if (cat_iter == CAT_API::API.end()) {
-							// Non-CAT API function calls require memory alias analysis
-							// If a function Mods a CAT variable or any of its aliases,
-							// it KILLs that variable's definition. If there is no MOD,
-							// the CAT variable is unaffected
-							std::vector<Instruction*> aliases;
-							do {
-								for (auto i = 0; i < index; i++) {
-									auto tempInst = DFA[i]->getInstruction();
-									for (auto j = 0; j < callInst->getNumArgOperands(); j++) {
-										// Make sure the CAT variable escapes
-										// errs() << *tempInst << "\n";
-										if (!DFA[i]->escapes()) { continue; }
-										// errs() << "escapes\n";
-										auto mr = AA.getModRefInfo(callInst, tempInst, 8);
-										printModRefInfo(mr);
-										// Make sure this function call modifies the CAT variable
-										if (mods(mr)) {
-											DFA[i]->add(index, DFA_SET::KILL);
-											p_dfa->add(i, DFA_SET::KILL);
-										}
-									}
+			// Go through the mapping of constant propagations and do them
+			for (auto prop_iter = propagations.begin(); prop_iter != propagations.end(); prop_iter++) {
+				// errs() << "CP: Replacing" << *(prop_iter->first) << " with " << *(prop_iter->second) << "\n";
+				// CAT_new and CAT_set calls of the value read become constant definitions
+				if (changed != nullptr) {
+					for (auto user : prop_iter->first->users()) {
+						auto callInst{ dyn_cast<CallInst>(user) };
+						if (callInst == nullptr) { continue; }
+						auto op{ classify(callInst) };
+						auto def{ DFA.getDefinition(callInst) };
+						if ((op == CAT_API::NEW || op == CAT_API::SET) && def != -1) {
+							changed->push_back(def);
+						}
+					}
+				}
+				BasicBlock::iterator ii(prop_iter->first);
+				ReplaceInstWithValue(prop_iter->first->getParent()->getInstList(), ii, prop_iter->second);
+				has_modified_code = true;
+			}
+
+			// Go through the mapping of constant foldings and do them
+			for (auto fold_iter = foldings.begin(); fold_iter != foldings.end(); fold_iter++) {
+				auto f{ declare(CAT_API::SET, ctx) };
+				std::vector<Value*> params{
+					/* param 0: CAT variable */
+					cast<CallInst>(fold_iter->first)->getArgOperand(0),
+					/* param 1: int */
+					ConstantInt::get(ctx, APInt(64, fold_iter->second, true))
+				};
+				// errs() << "CF: Replacing" << *(fold_iter->first) << " with CAT_set(" << fold_iter->second << ");\n";
+				auto setInst{ CallInst::Create(f, params) };
+				auto def{ changed != nullptr ? DFA.getDefinition(fold_iter->first) : -1 };
+				ReplaceInstWithInst(fold_iter->first, setInst);
+				// The definition is now made by the CAT_set call
+				if (def != -1) {
+					DFA.setInstruction(def, setInst);
+					changed->push_back(def);
+				}
+				has_modified_code = true;
+			}
+			return has_modified_code;
+		}
+
+		/// <summary>
+		/// Repeats constant propagation and folding with <c>reexamine</c> until no rewrite allows
+		/// another one, then drops the simplifications recorded for calls folded since.
+		/// </summary>
+		/// <param name='ctx'>The context of the function.</param>
+		/// <param name='changed'>The definitions changed by the first round.</param>
+		/// <returns>Whether anything was rewritten.</returns>
+		bool propagateToFixpoint(LLVMContext& ctx, SmallVectorImpl<int>& changed) {
+			auto rewritten{ false };
+			SmallPtrSet<const Instruction*, 16> folded;
+			while (!changed.empty()) {
+				NumFixpointRounds++;
+				reexamine(changed);
+				changed.clear();
+				for (auto& folding : foldings) {
+					folded.insert(folding.first);
+				}
+				rewritten |= applyRewrites(ctx, &changed);
+			}
+			// A call may have been recorded again with more zeros; only its last record is kept
+			SmallPtrSet<const CallInst*, 16> seen;
+			std::vector<std::pair<CallInst*, int>> kept;
+			for (auto iter = simplifications.rbegin(); iter != simplifications.rend(); iter++) {
+				if (folded.count(iter->first) || !seen.insert(iter->first).second) { continue; }
+				kept.push_back(*iter);
+			}
+			simplifications.assign(kept.rbegin(), kept.rend());
+			return rewritten;
+		}
+
+		/// <summary>Solves the reaching definitions of a function (Pass 2), and the value of each definition.</summary>
+		/// <param name='F'>The function, whose definitions have been added to the DFA.</param>
+		void solveDefinitions(Function& F) {
+			/* Pass 2: IN/OUT */
+			if (UseSlices) {
+				solveSlices();
+			}
+			else {
+				solveBlocks(F);
+			}
+
+			// for (auto block = 0; block < DFA.numBlocks(); block++) { DFA.print(block); }
+
+			computeConstants();
+		}
+
+		/// <summary>
+		/// Finds the constant propagations and foldings of a function with reaching definitions:
+		/// an IN/OUT fixpoint over the BasicBlocks (Pass 2), then a scan of every CAT API call (Pass 3).
+		/// </summary>
+		/// <param name='F'>The function, whose definitions have been added to the DFA.</param>
+		void solveReachingDefinitions(Function& F) {
+			solveDefinitions(F);
+
+			/* Pass 3: Constant Propagation, Constant Folding */
+			auto in{ UseSlices ? nullptr : DFA.getScratch(1) };
+			for (auto block = 0; block < DFA.numBlocks(); block++) {
+				// Rebuild each Instruction's IN set from the block's IN set while scanning the block
+				if (UseSlices) {
+					for (auto var : SLICES.touched) {
+						SLICES.current[var] = -1;
+					}
+					SLICES.touched.clear();
+				}
+				else {
+					DFA.copy(in, DFA.getSet(block, DFA_STATE::IN));
+				}
+				for (auto& I : *(DFA.getBlock(block))) {
+					// We're only interested in Call Instructions
+					if (auto callInst = dyn_cast<CallInst>(&I)) {
+						// errs() << "\n" << *callInst << "\n";
+						examine(callInst, [&](const Value* V) { return valueAtRead(in, block, V); });
+					}
+					// The OUT set of this Instruction is the IN set of the next one
+					auto def{ DFA.getDefinition(&I) };
+					if (def != -1) {
+						for (auto i = def; i < DFA.numDefinitions() && DFA.getInstruction(i) == &I; i++) {
+							if (UseSlices) {
+								SLICES.current[DFA.getVariableIndex(i)] = i;
+								SLICES.touched.push_back(DFA.getVariableIndex(i));
+							}
+							else {
+								DFA.apply(in, i);
+							}
+						}
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Finds the constant propagations and foldings of a function with sparse conditional
+		/// constant propagation: the definitions of each CAT variable are renamed into versions
+		/// over the dominator tree, then values only flow from versions and SSA values to their
+		/// readers, through CFG edges known to be executable. Unlike reaching definitions, this
+		/// sees through branches on CAT values, and through CAT_add and CAT_sub of constants.
+		/// </summary>
+		/// <param name='F'>The function, whose definitions have been added to the DFA.</param>
+		/// <param name='DT'>The dominator tree of the function.</param>
+		void solveSCCP(Function& F, DominatorTree& DT) {
+			SCCP.clear();
+			auto numDefs{ DFA.numDefinitions() };
+
+			/* Dominance frontiers */
+			// A join block is in the dominance frontier of every block from one of its
+			// predecessors up to (but excluding) its immediate dominator
+			for (auto block = 0; block < DFA.numBlocks(); block++) {
+				auto B{ DFA.getBlock(block) };
+				if (pred_size(B) < 2) { continue; }
+				auto idom{ DT.getNode(B)->getIDom() };
+				for (auto pred : predecessors(B)) {
+					auto runner{ DT.getNode(pred) };
+					// Predecessors in unreachable code have no dominator tree node
+					while (runner != nullptr && runner != idom) {
+						SCCP.frontier.push_back(std::make_pair(DFA.getBlockIndex(runner->getBlock()), block));
+						runner = runner->getIDom();
+					}
+				}
+			}
+			std::sort(SCCP.frontier.begin(), SCCP.frontier.end());
+			SCCP.frontier.erase(std::unique(SCCP.frontier.begin(), SCCP.frontier.end()), SCCP.frontier.end());
+			SCCP.frontier_begin.assign(DFA.numBlocks() + 1, 0);
+			for (auto& edge : SCCP.frontier) {
+				SCCP.frontier_begin[edge.first + 1]++;
+			}
+			for (auto block = 0; block < DFA.numBlocks(); block++) {
+				SCCP.frontier_begin[block + 1] += SCCP.frontier_begin[block];
+			}
+
+			/* Virtual PHIs */
+			// A CAT variable needs a virtual PHI in the iterated dominance frontier of its definitions,
+			// so different versions can only merge if it has more than one definition
+			SCCP.placed.assign(DFA.numBlocks(), -1);
+			SCCP.queued.assign(DFA.numBlocks(), -1);
+			for (auto var = 0; var < DFA.numVariables(); var++) {
+				auto defs{ DFA.getVariableDefinitions(var) };
+				if (defs.size() < 2) { continue; }
+				SCCP.blocks.clear();
+				for (auto i : defs) {
+					auto block{ DFA.getBlockIndex(DFA.getInstruction(i)->getParent()) };
+					if (SCCP.queued[block] != var) {
+						SCCP.queued[block] = var;
+						SCCP.blocks.push_back(block);
+					}
+				}
+				while (!SCCP.blocks.empty()) {
+					auto block{ SCCP.blocks.back() };
+					SCCP.blocks.pop_back();
+					for (auto f = SCCP.frontier_begin[block]; f < SCCP.frontier_begin[block + 1]; f++) {
+						auto join{ SCCP.frontier[f].second };
+						if (SCCP.placed[join] == var) { continue; }
+						SCCP.placed[join] = var;
+						SCCP.placement.push_back(std::make_pair(join, var));
+						// A virtual PHI is a definition too
+						if (SCCP.queued[join] != var) {
+							SCCP.queued[join] = var;
+							SCCP.blocks.push_back(join);
+						}
+					}
+				}
+			}
+			std::sort(SCCP.placement.begin(), SCCP.placement.end());
+			SCCP.vphi_begin.assign(DFA.numBlocks() + 1, 0);
+			for (auto& vphi : SCCP.placement) {
+				SCCP.vphi_block.push_back(vphi.first);
+				SCCP.vphi_var.push_back(vphi.second);
+				SCCP.vphi_begin[vphi.first + 1]++;
+			}
+			for (auto block = 0; block < DFA.numBlocks(); block++) {
+				SCCP.vphi_begin[block + 1] += SCCP.vphi_begin[block];
+			}
+			auto numVersions{ numDefs + (int)SCCP.vphi_var.size() };
+
+			/* Reads */
+			for (auto k = 0; k < SCCP.vphi_var.size(); k++) {
+				SCCP.vphi_use.push_back(SCCP.uses.size());
+				for (auto j = 0; j < pred_size(DFA.getBlock(SCCP.vphi_block[k])); j++) {
+					SCCP.uses.push_back(SCCP_USE{ -1, nullptr, k });
+				}
+			}
+			for (auto block = 0; block < DFA.numBlocks(); block++) {
+				for (auto& I : *(DFA.getBlock(block))) {
+					auto reads{ 0 };
+					if (auto phiInst = dyn_cast<PHINode>(&I)) {
+						if (DFA.getDefinition(phiInst) != -1) { reads = phiInst->getNumIncomingValues(); }
+					}
+					else if (auto callInst = dyn_cast<CallInst>(&I)) {
+						auto op{ classify(callInst) };
+						reads = (op == CAT_API::GET ? 1 : (op == CAT_API::ADD || op == CAT_API::SUB ? 2 : 0));
+					}
+					if (reads == 0) { continue; }
+					SCCP.use_index[&I] = SCCP.uses.size();
+					for (auto j = 0; j < reads; j++) {
+						SCCP.uses.push_back(SCCP_USE{ -1, &I, -1 });
+					}
+				}
+			}
+
+			/* Renaming */
+			// Walk the dominator tree, restoring the versions of the CAT variables when leaving a subtree
+			struct RENAME_FRAME {
+				DomTreeNode* node;
+				unsigned child;
+				unsigned mark;
+			};
+			SmallVector<RENAME_FRAME, 32> stack;
+			SCCP.current.assign(DFA.numVariables(), -1);
+			renameBlock(DT.getRootNode()->getBlock());
+			stack.push_back(RENAME_FRAME{ DT.getRootNode(), 0, 0 });
+			while (!stack.empty()) {
+				auto& frame{ stack.back() };
+				if (frame.child < frame.node->getNumChildren()) {
+					auto child{ *(frame.node->begin() + frame.child++) };
+					unsigned mark = SCCP.undo.size();
+					renameBlock(child->getBlock());
+					stack.push_back(RENAME_FRAME{ child, 0, mark });
+					continue;
+				}
+				while (SCCP.undo.size() > frame.mark) {
+					SCCP.current[SCCP.undo.back().first] = SCCP.undo.back().second;
+					SCCP.undo.pop_back();
+				}
+				stack.pop_back();
+			}
+
+			// Index the reads of each version
+			SCCP.user_begin.assign(numVersions + 1, 0);
+			for (auto& use : SCCP.uses) {
+				if (use.version != -1) { SCCP.user_begin[use.version + 1]++; }
+			}
+			for (auto v = 0; v < numVersions; v++) {
+				SCCP.user_begin[v + 1] += SCCP.user_begin[v];
+			}
+			SCCP.user_list.resize(SCCP.user_begin[numVersions]);
+			for (auto u = 0; u < SCCP.uses.size(); u++) {
+				if (SCCP.uses[u].version != -1) { SCCP.user_list[SCCP.user_begin[SCCP.uses[u].version]++] = u; }
+			}
+			for (auto v = numVersions; v > 0; v--) {
+				SCCP.user_begin[v] = SCCP.user_begin[v - 1];
+			}
+			SCCP.user_begin[0] = 0;
+
+			/* Propagation */
+			constants.assign(numVersions, LATTICE_VALUE());
+			SCCP.executable.resize(DFA.numBlocks());
+			markExecutable(&F.getEntryBlock());
+			while (!SCCP.inst_worklist.empty() || !SCCP.vphi_worklist.empty()) {
+				while (!SCCP.vphi_worklist.empty()) {
+					auto k{ SCCP.vphi_worklist.back() };
+					SCCP.vphi_worklist.pop_back();
+					visitVirtualPhi(k);
+				}
+				while (!SCCP.inst_worklist.empty()) {
+					auto I{ SCCP.inst_worklist.back() };
+					SCCP.inst_worklist.pop_back();
+					visitInstruction(I);
+				}
+			}
+
+			/* Constant Propagation, Constant Folding */
+			for (auto block = 0; block < DFA.numBlocks(); block++) {
+				if (!SCCP.executable.test(block)) { continue; }
+				for (auto& I : *(DFA.getBlock(block))) {
+					auto callInst{ dyn_cast<CallInst>(&I) };
+					if (callInst == nullptr) { continue; }
+					auto op{ classify(callInst) };
+					if (op == CAT_API::GET) {
+						auto value{ SCCP.values.lookup(callInst) };
+						if (value.isConstant()) {
+							propagations.push_back(std::pair<Instruction*, Value*>(callInst, value.getConstant()));
+						}
+					}
+					else if (op == CAT_API::ADD || op == CAT_API::SUB) {
+						auto& value{ constants[DFA.getDefinition(callInst)] };
+						if (value.isConstant()) {
+							foldings.push_back(std::pair<Instruction*, int64_t>(callInst, value.getConstant()->getSExtValue()));
+						}
+						else if (UseSimplification) {
+							auto use{ SCCP.use_index[callInst] };
+							addSimplification(callInst, versionValue(SCCP.uses[use].version), versionValue(SCCP.uses[use + 1].version));
+						}
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Renames the definitions of a block: records the version of the CAT variables read
+		/// by its CAT API calls and by the PHIs and virtual PHIs of its successors, and makes
+		/// its own definitions the current versions. Pass 1 recorded a (re)definition through a
+		/// handle on every handle <c>computePhiAliases</c> grouped it with, so it becomes the
+		/// current version of all of their CAT variables.
+		/// </summary>
+		/// <param name='B'>The block, whose dominators have been renamed.</param>
+		void renameBlock(BasicBlock* B) {
+			auto block{ DFA.getBlockIndex(B) };
+			auto push = [&](int var, int version) {
+				SCCP.undo.push_back(std::make_pair(var, SCCP.current[var]));
+				SCCP.current[var] = version;
+			};
+			auto versionOf = [&](const Value* V) {
+				auto var{ DFA.getVariableIndex(V) };
+				return var == -1 ? -1 : SCCP.current[var];
+			};
+			for (auto k = SCCP.vphi_begin[block]; k < SCCP.vphi_begin[block + 1]; k++) {
+				push(SCCP.vphi_var[k], DFA.numDefinitions() + k);
+			}
+			for (auto& I : *B) {
+				// Reads happen before the definitions of the same call
+				if (auto callInst = dyn_cast<CallInst>(&I)) {
+					auto use_iter{ SCCP.use_index.find(callInst) };
+					if (use_iter != SCCP.use_index.end()) {
+						if (classify(callInst) == CAT_API::GET) {
+							SCCP.uses[use_iter->second].version = versionOf(callInst->getArgOperand(0));
+						}
+						else {
+							SCCP.uses[use_iter->second].version = versionOf(callInst->getArgOperand(1));
+							SCCP.uses[use_iter->second + 1].version = versionOf(callInst->getArgOperand(2));
+						}
+					}
+				}
+				auto def{ DFA.getDefinition(&I) };
+				if (def == -1) { continue; }
+				for (auto i = def; i < DFA.numDefinitions() && DFA.getInstruction(i) == &I; i++) {
+					push(DFA.getVariableIndex(i), i);
+				}
+			}
+			// The versions at the end of this block flow into the PHIs of its successors
+			for (auto S : successors(B)) {
+				auto succ{ DFA.getBlockIndex(S) };
+				for (auto k = SCCP.vphi_begin[succ]; k < SCCP.vphi_begin[succ + 1]; k++) {
+					auto j{ SCCP.vphi_use[k] };
+					for (auto pred : predecessors(S)) {
+						if (pred == B) { SCCP.uses[j].version = SCCP.current[SCCP.vphi_var[k]]; }
+						j++;
+					}
+				}
+				for (auto& phiInst : S->phis()) {
+					auto use_iter{ SCCP.use_index.find(&phiInst) };
+					if (use_iter == SCCP.use_index.end()) { continue; }
+					for (auto j = 0; j < phiInst.getNumIncomingValues(); j++) {
+						if (phiInst.getIncomingBlock(j) == B) {
+							SCCP.uses[use_iter->second + j].version = versionOf(phiInst.getIncomingValue(j));
+						}
+					}
+				}
+			}
+		}
+
+		/// <summary>Tests if the SCCP engine tracks the value of an SSA <c>Value</c>.</summary>
+		bool isTracked(const Value* V) {
+			return V->getType()->isIntegerTy() && V->getType()->getIntegerBitWidth() <= 64;
+		}
+
+		/// <summary>Gets the lattice value of a version of a CAT variable, NONCONSTANT if there is none.</summary>
+		LATTICE_VALUE versionValue(int version) {
+			return version == -1 ? LATTICE_VALUE(nullptr) : constants[version];
+		}
+
+		/// <summary>Gets the lattice value of an SSA <c>Value</c>.</summary>
+		LATTICE_VALUE valueOf(const Value* V) {
+			if (auto c = dyn_cast<ConstantInt>(V)) { return LATTICE_VALUE(const_cast<ConstantInt*>(c)); }
+			auto I{ dyn_cast<Instruction>(V) };
+			if (I == nullptr || !isTracked(I)) { return LATTICE_VALUE(nullptr); }
+			return SCCP.values.lookup(I);
+		}
+
+		/// <summary>Lowers the lattice value of a version, and revisits its executable readers if it changed.</summary>
+		void updateVersion(int version, const LATTICE_VALUE& value) {
+			if (!constants[version].meet(value)) { return; }
+			for (auto u = SCCP.user_begin[version]; u < SCCP.user_begin[version + 1]; u++) {
+				auto& use{ SCCP.uses[SCCP.user_list[u]] };
+				if (use.inst != nullptr) {
+					if (SCCP.executable.test(DFA.getBlockIndex(use.inst->getParent()))) { SCCP.inst_worklist.push_back(use.inst); }
+				}
+				else if (SCCP.executable.test(SCCP.vphi_block[use.vphi])) {
+					SCCP.vphi_worklist.push_back(use.vphi);
+				}
+			}
+		}
+
+		/// <summary>Lowers the lattice value of an SSA <c>Instruction</c>, and revisits its executable users if it changed.</summary>
+		void updateValue(Instruction* I, const LATTICE_VALUE& value) {
+			if (!SCCP.values[I].meet(value)) { return; }
+			for (auto user : I->users()) {
+				auto userInst{ dyn_cast<Instruction>(user) };
+				if (userInst == nullptr) { continue; }
+				auto block{ DFA.getBlockIndex(userInst->getParent()) };
+				if (block != -1 && SCCP.executable.test(block)) { SCCP.inst_worklist.push_back(userInst); }
+			}
+		}
+
+		/// <summary>Marks a block executable, and visits all of it the first time.</summary>
+		void markExecutable(BasicBlock* B) {
+			auto block{ DFA.getBlockIndex(B) };
+			if (SCCP.executable.test(block)) {
+				// A new incoming edge only changes the PHIs
+				for (auto k = SCCP.vphi_begin[block]; k < SCCP.vphi_begin[block + 1]; k++) {
+					SCCP.vphi_worklist.push_back(k);
+				}
+				for (auto& phiInst : B->phis()) {
+					SCCP.inst_worklist.push_back(&phiInst);
+				}
+				return;
+			}
+			SCCP.executable.set(block);
+			for (auto k = SCCP.vphi_begin[block]; k < SCCP.vphi_begin[block + 1]; k++) {
+				SCCP.vphi_worklist.push_back(k);
+			}
+			// Visit the Instructions in program order
+			for (auto iter = B->rbegin(); iter != B->rend(); iter++) {
+				SCCP.inst_worklist.push_back(&*iter);
+			}
+		}
+
+		/// <summary>Marks a CFG edge executable.</summary>
+		void markEdge(BasicBlock* from, BasicBlock* to) {
+			if (SCCP.executable_edges.insert(std::make_pair(from, to)).second) {
+				markExecutable(to);
+			}
+		}
+
+		/// <summary>Computes the value of a virtual PHI from its executable incoming edges.</summary>
+		void visitVirtualPhi(int k) {
+			auto B{ DFA.getBlock(SCCP.vphi_block[k]) };
+			auto j{ SCCP.vphi_use[k] };
+			LATTICE_VALUE value;
+			for (auto pred : predecessors(B)) {
+				if (SCCP.executable_edges.count(std::make_pair(pred, B))) {
+					value.meet(versionValue(SCCP.uses[j].version));
+				}
+				j++;
+			}
+			updateVersion(DFA.numDefinitions() + k, value);
+		}
+
+		/// <summary>Computes the value of an <c>Instruction</c>, of the versions it defines, or of the edges it makes executable.</summary>
+		void visitInstruction(Instruction* I) {
+			NumSCCPVisits++;
+			auto B{ I->getParent() };
+			if (auto phiInst = dyn_cast<PHINode>(I)) {
+				auto def{ DFA.getDefinition(phiInst) };
+				LATTICE_VALUE value;
+				for (auto j = 0; j < phiInst->getNumIncomingValues(); j++) {
+					if (!SCCP.executable_edges.count(std::make_pair(phiInst->getIncomingBlock(j), B))) { continue; }
+					if (def != -1) {
+						value.meet(versionValue(SCCP.uses[SCCP.use_index[phiInst] + j].version));
+					}
+					else {
+						value.meet(valueOf(phiInst->getIncomingValue(j)));
+					}
+				}
+				if (def != -1) {
+					updateVersion(def, value);
+				}
+				else {
+					updateValue(phiInst, isTracked(phiInst) ? value : LATTICE_VALUE(nullptr));
+				}
+				return;
+			}
+			if (auto callInst = dyn_cast<CallInst>(I)) {
+				auto def{ DFA.getDefinition(callInst) };
+				switch (classify(callInst)) {
+				case CAT_API::NEW:
+					updateVersion(def, valueOf(callInst->getArgOperand(0)));
+					break;
+				case CAT_API::SET:
+					updateVersion(def, valueOf(callInst->getArgOperand(1)));
+					break;
+				case CAT_API::ADD:
+				case CAT_API::SUB: {
+					auto use{ SCCP.use_index[callInst] };
+					auto value1{ versionValue(SCCP.uses[use].version) };
+					auto value2{ versionValue(SCCP.uses[use + 1].version) };
+					if (value1.isConstant() && value2.isConstant()) {
+						auto val1{ value1.getConstant()->getValue() };
+						auto val2{ value2.getConstant()->getValue() };
+						auto result{ classify(callInst) == CAT_API::ADD ? val1 + val2 : val1 - val2 };
+						updateVersion(def, LATTICE_VALUE(ConstantInt::get(callInst->getContext(), result)));
+					}
+					else if (value1.getState() == LATTICE_VALUE::NONCONSTANT || value2.getState() == LATTICE_VALUE::NONCONSTANT) {
+						updateVersion(def, LATTICE_VALUE(nullptr));
+					}
+					break;
+				}
+				case CAT_API::GET:
+					updateValue(callInst, versionValue(SCCP.uses[SCCP.use_index[callInst]].version));
+					break;
+				case CAT_API::CALL:
+					// Anything this call may (re)define is unknown
+					for (auto i = def; def != -1 && i < DFA.numDefinitions() && DFA.getInstruction(i) == callInst; i++) {
+						updateVersion(i, LATTICE_VALUE(nullptr));
+					}
+					updateValue(callInst, LATTICE_VALUE(nullptr));
+					break;
+				}
+				// So are the CAT variables of the handles a PHI merges with the one (re)defined
+				for (auto i = def + 1; def != -1 && i < DFA.numDefinitions() && DFA.getInstruction(i) == callInst; i++) {
+					updateVersion(i, LATTICE_VALUE(nullptr));
+				}
+				return;
+			}
+			if (auto branchInst = dyn_cast<BranchInst>(I)) {
+				if (branchInst->isConditional()) {
+					auto cond{ valueOf(branchInst->getCondition()) };
+					if (cond.isConstant()) {
+						markEdge(B, branchInst->getSuccessor(cond.getConstant()->isZero() ? 1 : 0));
+						return;
+					}
+					if (cond.getState() == LATTICE_VALUE::UNKNOWN) { return; }
+				}
+				for (auto S : successors(B)) { markEdge(B, S); }
+				return;
+			}
+			if (auto switchInst = dyn_cast<SwitchInst>(I)) {
+				auto cond{ valueOf(switchInst->getCondition()) };
+				if (cond.isConstant()) {
+					markEdge(B, switchInst->findCaseValue(cond.getConstant())->getCaseSuccessor());
+					return;
+				}
+				if (cond.getState() == LATTICE_VALUE::UNKNOWN) { return; }
+				for (auto S : successors(B)) { markEdge(B, S); }
+				return;
+			}
+			if (I->isTerminator()) {
+				for (auto S : successors(B)) { markEdge(B, S); }
+				return;
+			}
+			// Only integer arithmetic, comparisons, casts and selects are folded
+			if (!isTracked(I) || !(isa<BinaryOperator>(I) || isa<CmpInst>(I) || isa<CastInst>(I) || isa<SelectInst>(I))) {
+				updateValue(I, LATTICE_VALUE(nullptr));
+				return;
+			}
+			SmallVector<Constant*, 4> operands;
+			for (auto& operand : I->operands()) {
+				auto value{ valueOf(operand) };
+				if (value.getState() == LATTICE_VALUE::NONCONSTANT) {
+					updateValue(I, value);
+					return;
+				}
+				// Wait until every operand is known
+				if (value.getState() == LATTICE_VALUE::UNKNOWN) { return; }
+				operands.push_back(value.getConstant());
+			}
+			auto& DL{ I->getModule()->getDataLayout() };
+			Constant* c;
+			if (auto cmpInst = dyn_cast<CmpInst>(I)) {
+				c = ConstantFoldCompareInstOperands(cmpInst->getPredicate(), operands[0], operands[1], DL);
+			}
+			else {
+				c = ConstantFoldInstOperands(I, operands, DL);
+			}
+			updateValue(I, LATTICE_VALUE(dyn_cast_or_null<ConstantInt>(c)));
+		}
+
+		/// <summary>Tests if a CAT variable never escapes its function: every use of it is an operand of CAT_get, CAT_set, CAT_add or CAT_sub.</summary>
+		/// <param name='newInst'>The call to CAT_new creating the CAT variable.</param>
+		bool isPromotable(const CallInst* newInst) {
+			for (auto& use : newInst->uses()) {
+				auto callInst{ dyn_cast<CallInst>(use.getUser()) };
+				if (callInst == nullptr || !callInst->isArgOperand(&use)) { return false; }
+				auto op{ classify(callInst) };
+				if (op != CAT_API::GET && op != CAT_API::SET && op != CAT_API::ADD && op != CAT_API::SUB) { return false; }
+				// CAT_set only reads its CAT variable from operand 0
+				if (op == CAT_API::SET && callInst->getArgOperandNo(&use) != 0) { return false; }
+			}
+			return true;
+		}
+
+		/// <summary>Records a CAT_add or CAT_sub call that could not be folded for simplification.</summary>
+		/// <param name='callInst'>The call.</param>
+		/// <param name='value1'>The value of its operand 1 where it is read.</param>
+		/// <param name='value2'>The value of its operand 2 where it is read.</param>
+		void addSimplification(CallInst* callInst, const LATTICE_VALUE& value1, const LATTICE_VALUE& value2) {
+			auto zeros{ 0 };
+			if (value1.isConstant() && value1.getConstant()->isZero()) { zeros |= 1; }
+			if (value2.isConstant() && value2.getConstant()->isZero()) { zeros |= 2; }
+			simplifications.push_back(std::make_pair(callInst, zeros));
+		}
+
+		/// <summary>
+		/// Rewrites each recorded CAT_add and CAT_sub call with the first identity of <c>CAT_IDENTITY::TABLE</c> it matches.
+		/// </summary>
+		/// <returns>true if any call was rewritten, false otherwise.</returns>
+		bool simplify() {
+			auto simplified{ false };
+			for (auto& simplification : simplifications) {
+				auto callInst{ simplification.first };
+				auto zeros{ simplification.second };
+				auto op{ classify(callInst) };
+				auto dest{ callInst->getArgOperand(0) };
+				for (auto& identity : CAT_IDENTITY::TABLE) {
+					if (identity.op != op) { continue; }
+					auto matches{ false };
+					switch (identity.pattern) {
+					case CAT_IDENTITY::SAME_OPERANDS:
+						matches = callInst->getArgOperand(1) == callInst->getArgOperand(2);
+						break;
+					case CAT_IDENTITY::ZERO_1:
+						matches = (zeros & 1) != 0;
+						break;
+					case CAT_IDENTITY::ZERO_2:
+						matches = (zeros & 2) != 0;
+						break;
+					case CAT_IDENTITY::DEST_2:
+						matches = callInst->getArgOperand(2) == dest && callInst->getArgOperand(1) != dest;
+						break;
+					}
+					if (!matches) { continue; }
+					if (identity.rewrite == CAT_IDENTITY::SET_ZERO) {
+						auto& ctx{ callInst->getContext() };
+						std::vector<Value*> params{ dest, ConstantInt::get(IntegerType::get(ctx, 64), 0) };
+						ReplaceInstWithInst(callInst, CallInst::Create(declare(CAT_API::SET, ctx), params));
+					}
+					else if (identity.rewrite == CAT_IDENTITY::COMMUTE) {
+						callInst->setArgOperand(2, callInst->getArgOperand(1));
+						callInst->setArgOperand(1, dest);
+					}
+					else {
+						// A copy to another CAT variable would take a CAT_get and a CAT_set
+						if (callInst->getArgOperand(identity.rewrite == CAT_IDENTITY::COPY_1 ? 1 : 2) != dest) { continue; }
+						callInst->eraseFromParent();
+					}
+					NumSimplified++;
+					simplified = true;
+					break;
+				}
+			}
+			simplifications.clear();
+			return simplified;
+		}
+
+		/// <summary>
+		/// Groups the handles merged by the pointer PHIs of the function. A PHI names the same CAT
+		/// variable as one of its incoming handles, so a (re)definition through any handle of a group
+		/// may (re)define the CAT variable of every other one, and Pass 1 records it on all of them.
+		/// </summary>
+		/// <param name='F'>The function.</param>
+		/// <param name='DT'>The dominator tree of the function, used to check for unreachable code.</param>
+		void computePhiAliases(Function& F, DominatorTree& DT) {
+			alias_group.clear();
+			alias_values.clear();
+			alias_parent.clear();
+			auto indexOf = [&](Value* V) {
+				auto iter{ alias_group.insert(std::make_pair(V, (int)alias_values.size())) };
+				if (iter.second) {
+					alias_values.push_back(V);
+					alias_parent.push_back(iter.first->second);
+				}
+				return iter.first->second;
+			};
+			auto find = [&](int a) {
+				while (alias_parent[a] != a) {
+					a = alias_parent[a] = alias_parent[alias_parent[a]];
+				}
+				return a;
+			};
+			for (auto& B : F) {
+				// Skip unreachable code
+				if (DT.getNode(&B) == NULL) { continue; }
+
+				for (auto& phiInst : B.phis()) {
+					if (!phiInst.getType()->isPointerTy()) { continue; }
+					auto phi{ indexOf(&phiInst) };
+					for (auto& incoming : phiInst.incoming_values()) {
+						// Constants such as null name no CAT variable
+						if (isa<Constant>(incoming)) { continue; }
+						auto root{ find(indexOf(incoming)) };
+						alias_parent[root] = find(phi);
+					}
+				}
+			}
+			// Counting sort of the handles by group
+			alias_begin.assign(alias_values.size() + 1, 0);
+			for (auto a = 0; a < alias_values.size(); a++) {
+				alias_parent[a] = find(a);
+				alias_begin[alias_parent[a] + 1]++;
+			}
+			for (auto g = 0; g < alias_values.size(); g++) {
+				alias_begin[g + 1] += alias_begin[g];
+			}
+			alias_members.resize(alias_values.size());
+			for (auto a = 0; a < alias_values.size(); a++) {
+				alias_members[alias_begin[alias_parent[a]]++] = alias_values[a];
+			}
+			for (auto g = alias_values.size(); g > 0; g--) {
+				alias_begin[g] = alias_begin[g - 1];
+			}
+			alias_begin[0] = 0;
+			for (auto& entry : alias_group) {
+				entry.second = alias_parent[entry.second];
+			}
+		}
+
+		/// <summary>Calls a function on a handle and on every handle <c>computePhiAliases</c> grouped it with.</summary>
+		template <typename Callback>
+		void forEachAlias(Value* V, Callback callback) {
+			auto iter{ alias_group.find(V) };
+			if (iter == alias_group.end()) {
+				callback(V);
+				return;
+			}
+			for (auto a = alias_begin[iter->second]; a < alias_begin[iter->second + 1]; a++) {
+				callback(alias_members[a]);
+			}
+		}
+
+		/// <summary>
+		/// Counts the definitions of each CAT variable in a loop into <c>loop_defs</c>. The calls
+		/// defining them may have been folded since Pass 1, so only their positions are used.
+		/// </summary>
+		void countLoopDefinitions(const Loop* L) {
+			loop_defs.assign(DFA.numVariables(), 0);
+			for (auto B : L->blocks()) {
+				auto block{ DFA.getBlockIndex(B) };
+				for (auto def = DFA.getEntry(block); def < DFA.getExit(block); def++) {
+					loop_defs[DFA.getVariableIndex(def)]++;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Computes the value of a CAT variable when a loop is entered from its preheader, from the
+		/// OUT SET of the preheader, or from the version reaching the virtual PHI of the loop header
+		/// with SCCP. CAT variables without a virtual PHI in the header are not (re)defined in the
+		/// loop, and their value is then the meet of all of their definitions.
+		/// </summary>
+		/// <param name='L'>The loop, which has a preheader.</param>
+		/// <param name='V'>The CAT variable.</param>
+		LATTICE_VALUE valueOnEntry(const Loop* L, const Value* V) {
+			auto preheader{ L->getLoopPreheader() };
+			if (!UseSCCP) {
+				return valueAtEnd(DFA.getBlockIndex(preheader), V);
+			}
+			auto var{ DFA.getVariableIndex(V) };
+			auto header{ DFA.getBlockIndex(L->getHeader()) };
+			for (auto k = SCCP.vphi_begin[header]; k < SCCP.vphi_begin[header + 1]; k++) {
+				if (SCCP.vphi_var[k] != var) { continue; }
+				auto j{ SCCP.vphi_use[k] };
+				for (auto pred : predecessors(L->getHeader())) {
+					if (pred == preheader) { return versionValue(SCCP.uses[j].version); }
+					j++;
+				}
+			}
+			LATTICE_VALUE value;
+			for (auto i : DFA.getDefinitions(V)) {
+				value.meet(constants[i]);
+			}
+			return value.getState() == LATTICE_VALUE::UNKNOWN ? LATTICE_VALUE(nullptr) : value;
+		}
+
+		/// <summary>
+		/// Rewrites the CAT induction variables of every loop whose backedge-taken count is a
+		/// constant, innermost loops first. A CAT induction variable is (re)defined in the loop only by
+		/// <para>CAT_add(i, i, step), CAT_add(i, step, i) or CAT_sub(i, i, step)</para>
+		/// with a constant <c>step</c> not (re)defined in the loop, once per iteration: in a block of the
+		/// loop itself rather than of an inner loop, dominating the latch. That call is
+		/// replaced by an <c>i64</c> PHI in the loop header and CAT_get calls of <c>i</c> in the loop read it,
+		/// then <c>i</c> is given its closed-form value <c>init + count * step</c> in the exit block,
+		/// where the CAT_get calls of <c>i</c> read it directly. Only CAT variables that never escape,
+		/// and are only read by CAT_get in the loop, are rewritten; each of them in one loop at most.
+		/// </summary>
+		/// <param name='LI'>The loops of the function.</param>
+		/// <param name='DT'>The dominator tree of the function.</param>
+		/// <param name='SE'>The scalar evolution of the function.</param>
+		/// <returns>true if any CAT induction variable was rewritten, false otherwise.</returns>
+		bool rewriteInductionVariables(LoopInfo& LI, DominatorTree& DT, ScalarEvolution& SE) {
+			auto rewritten{ false };
+			BitVector done(DFA.numVariables());
+			auto loops{ LI.getLoopsInPreorder() };
+			for (auto iter = loops.rbegin(); iter != loops.rend(); iter++) {
+				auto L{ *iter };
+				auto preheader{ L->getLoopPreheader() };
+				auto latch{ L->getLoopLatch() };
+				auto exiting{ L->getExitingBlock() };
+				auto exit{ L->getExitBlock() };
+				if (preheader == nullptr || latch == nullptr || exiting == nullptr || exit == nullptr) { continue; }
+				if (exit->getSinglePredecessor() != exiting) { continue; }
+				auto backedges{ dyn_cast<SCEVConstant>(SE.getBackedgeTakenCount(L)) };
+				if (backedges == nullptr) { continue; }
+				countLoopDefinitions(L);
+
+				std::vector<CallInst*> candidates;
+				for (auto B : L->blocks()) {
+					// Calls of inner loops may run any number of times per iteration
+					if (LI.getLoopFor(B) != L) { continue; }
+					for (auto& I : *B) {
+						auto callInst{ dyn_cast<CallInst>(&I) };
+						if (callInst == nullptr) { continue; }
+						auto op{ classify(callInst) };
+						if (op == CAT_API::ADD || op == CAT_API::SUB) { candidates.push_back(callInst); }
+					}
+				}
+				for (auto callInst : candidates) {
+					auto op{ classify(callInst) };
+					auto V{ callInst->getArgOperand(0) };
+					auto var{ DFA.getVariableIndex(V) };
+					if (var == -1 || done.test(var) || loop_defs[var] != 1) { continue; }
+					auto newInst{ dyn_cast<CallInst>(V) };
+					if (newInst == nullptr || classify(newInst) != CAT_API::NEW || !isPromotable(newInst) || L->contains(newInst)) { continue; }
+					// i = i + step, i = step + i or i = i - step
+					Value* step;
+					if (callInst->getArgOperand(1) == V) { step = callInst->getArgOperand(2); }
+					else if (op == CAT_API::ADD && callInst->getArgOperand(2) == V) { step = callInst->getArgOperand(1); }
+					else { continue; }
+					auto stepVar{ DFA.getVariableIndex(step) };
+					if (step == V || !L->isLoopInvariant(step) || (stepVar != -1 && loop_defs[stepVar] != 0)) { continue; }
+					auto stepValue{ valueOnEntry(L, step) };
+					if (!stepValue.isConstant()) { continue; }
+
+					// The call runs once per iteration, before or after the exit is taken
+					auto B{ callInst->getParent() };
+					if (!DT.dominates(callInst, latch->getTerminator())) { continue; }
+					APInt count{ backedges->getAPInt().zextOrTrunc(64) };
+					if (DT.dominates(B, exiting)) { count += 1; }
+					else if (!DT.dominates(exiting, B)) { continue; }
+
+					// Every read in the loop must come either before or after the call in each iteration
+					std::vector<CallInst*> before;
+					std::vector<CallInst*> after;
+					auto reads{ true };
+					for (auto user : V->users()) {
+						auto userInst{ cast<CallInst>(user) };
+						if (userInst == callInst || !L->contains(userInst)) { continue; }
+						if (classify(userInst) != CAT_API::GET) { reads = false; }
+						else if (DT.dominates(callInst, userInst)) { after.push_back(userInst); }
+						else if (DT.dominates(userInst, callInst)) { before.push_back(userInst); }
+						else { reads = false; }
+					}
+					if (!reads) { continue; }
+
+					auto& ctx{ callInst->getContext() };
+					auto intType{ IntegerType::get(ctx, 64) };
+					auto delta{ stepValue.getConstant()->getValue().sextOrTrunc(64) };
+					if (op == CAT_API::SUB) { delta.negate(); }
+					// The value of i when the loop is entered
+					Value* init;
+					auto initValue{ valueOnEntry(L, V) };
+					if (initValue.isConstant()) {
+						init = ConstantInt::get(intType, initValue.getConstant()->getValue().sextOrTrunc(64));
+					}
+					else {
+						IRBuilder<> builder(preheader->getTerminator());
+						init = builder.CreateCall(declare(CAT_API::GET, ctx), { V });
+					}
+					// The value of i on each iteration, before and after the call
+					if (!before.empty() || !after.empty()) {
+						auto phi{ PHINode::Create(intType, pred_size(L->getHeader()), "", &L->getHeader()->front()) };
+						IRBuilder<> builder(callInst);
+						auto next{ builder.CreateAdd(phi, ConstantInt::get(intType, delta)) };
+						for (auto pred : predecessors(L->getHeader())) {
+							phi->addIncoming(pred == preheader ? init : next, pred);
+						}
+						for (auto getInst : before) {
+							getInst->replaceAllUsesWith(phi);
+							getInst->eraseFromParent();
+						}
+						for (auto getInst : after) {
+							getInst->replaceAllUsesWith(next);
+							getInst->eraseFromParent();
+						}
+					}
+					callInst->eraseFromParent();
+
+					// The closed-form value of i once the loop exits
+					IRBuilder<> builder(&*(exit->getFirstInsertionPt()));
+					auto final{ builder.CreateAdd(init, ConstantInt::get(intType, delta * count)) };
+					auto setInst{ builder.CreateCall(declare(CAT_API::SET, ctx), { V, final }) };
+					// The reads of i in the exit block up to its next definition fold to it
+					for (auto I = setInst->getNextNode(); I != nullptr; I = I->getNextNode()) {
+						auto readInst{ dyn_cast<CallInst>(I) };
+						if (readInst == nullptr || !is_contained(readInst->args(), V)) { continue; }
+						if (classify(readInst) != CAT_API::GET) { break; }
+						I = I->getPrevNode();
+						readInst->replaceAllUsesWith(final);
+						readInst->eraseFromParent();
+					}
+					done.set(var);
+					NumInductionVariables++;
+					rewritten = true;
+				}
+			}
+			return rewritten;
+		}
+
+		/// <summary>
+		/// Hoists the CAT API calls of every loop whose result is the same on every iteration into
+		/// the loop's preheader, innermost loops first so a call can leave a whole loop nest:
+		/// <para>CAT_get of a CAT variable that no definition in the loop KILLs</para>
+		/// <para>CAT_set, CAT_add and CAT_sub whose operands no definition in the loop KILLs, when they
+		/// are the only definition of their CAT variable in the loop, run on every iteration, and
+		/// come before every read of it in the loop</para>
+		/// The definitions of the loop are those found by Pass 1, so calls of the loop that may
+		/// modify a CAT variable KILL it too, and so do those through a handle a PHI merges it with.
+		/// </summary>
+		/// <param name='LI'>The loops of the function.</param>
+		/// <param name='DT'>The dominator tree of the function.</param>
+		/// <returns>true if any call was hoisted, false otherwise.</returns>
+		bool hoistLoopInvariants(LoopInfo& LI, DominatorTree& DT) {
+			auto hoisted{ false };
+			auto loops{ LI.getLoopsInPreorder() };
+			for (auto iter = loops.rbegin(); iter != loops.rend(); iter++) {
+				auto L{ *iter };
+				auto preheader{ L->getLoopPreheader() };
+				SmallVector<BasicBlock*, 4> exiting;
+				L->getExitingBlocks(exiting);
+				if (preheader == nullptr || exiting.empty()) { continue; }
+
+				countLoopDefinitions(L);
+				// Pass 1 also recorded the definitions through a handle merged with V by a PHI on V
+				auto definitions = [&](Value* V) {
+					auto var{ DFA.getVariableIndex(V) };
+					return var == -1 ? 0 : loop_defs[var];
+				};
+				auto invariant = [&](Value* V) {
+					return L->isLoopInvariant(V) && definitions(V) == 0;
+				};
+
+				std::vector<CallInst*> calls;
+				for (auto B : L->blocks()) {
+					// Calls of inner loops were already considered with them
+					if (LI.getLoopFor(B) != L) { continue; }
+					for (auto& I : *B) {
+						auto callInst{ dyn_cast<CallInst>(&I) };
+						if (callInst == nullptr) { continue; }
+						switch (classify(callInst)) {
+						case CAT_API::GET:
+							if (invariant(callInst->getArgOperand(0))) { calls.push_back(callInst); }
+							break;
+						case CAT_API::SET:
+						case CAT_API::ADD:
+						case CAT_API::SUB: {
+							auto V{ callInst->getArgOperand(0) };
+							if (!L->isLoopInvariant(V) || definitions(V) != 1 || DFA.escaping.count(V)) { break; }
+							auto operands{ true };
+							for (auto i = 1; i < callInst->getNumArgOperands(); i++) {
+								auto operand{ callInst->getArgOperand(i) };
+								operands &= operand->getType()->isPointerTy() ? invariant(operand) : L->isLoopInvariant(operand);
+							}
+							if (!operands) { break; }
+							// It must run on every iteration...
+							auto always{ true };
+							for (auto E : exiting) {
+								always &= DT.dominates(B, E);
+							}
+							if (!always) { break; }
+							// ...before anything in the loop reads the CAT variable, through any handle
+							auto first{ true };
+							forEachAlias(V, [&](Value* A) {
+								for (auto user : A->users()) {
+									auto userInst{ dyn_cast<Instruction>(user) };
+									if (userInst == nullptr || userInst == callInst || !L->contains(userInst)) { continue; }
+									first &= DT.dominates(callInst, userInst);
 								}
-							} while (!aliases.size() == 0);
+							});
+							if (!first) { break; }
+							calls.push_back(callInst);
+							// Once hoisted, it no longer KILLs the CAT variable in the loop, through any handle
+							forEachAlias(V, [&](Value* A) {
+								auto var{ DFA.getVariableIndex(A) };
+								if (var != -1) { loop_defs[var]--; }
+							});
+							break;
+						}
+						default:
+							break;
 						}
 					}
-					else if (auto phiInst = dyn_cast<PHINode>(&I)) {
-						for (auto i = 0; i < index; i++) {
-							if (defines(DFA[i]->getInstruction(), phiInst, AA)) {
-								DFA[i]->add(index, DFA_SET::KILL);
-								p_dfa->add(i, DFA_SET::KILL);
+				}
+				// Calls are moved in program order, so the preheader keeps their order
+				for (auto callInst : calls) {
+					callInst->moveBefore(preheader->getTerminator());
+					NumHoisted++;
+					hoisted = true;
+				}
+			}
+			return hoisted;
+		}
+
+		/// <summary>
+		/// Calls a function on the index in <c>read_index</c> of every CAT variable an <c>Instruction</c>
+		/// (re)defines. Calls to other functions (re)define what Pass 1 found they may modify, and a
+		/// (re)definition through a handle also (re)defines the handles <c>computePhiAliases</c> grouped it with.
+		/// </summary>
+		template <typename Callback>
+		void forEachReadDefined(Instruction* I, Callback callback) {
+			auto visit = [&](const Value* V) {
+				auto iter{ read_index.find(V) };
+				if (iter != read_index.end()) { callback(iter->second); }
+			};
+			// A new handle, from CAT_new or a PHI, holds a new value
+			visit(I);
+			auto callInst{ dyn_cast<CallInst>(I) };
+			if (callInst == nullptr) { return; }
+			auto op{ classify(callInst) };
+			if (op == CAT_API::SET || op == CAT_API::ADD || op == CAT_API::SUB) {
+				forEachAlias(callInst->getArgOperand(0), visit);
+			}
+			else if (op == CAT_API::CALL) {
+				auto def{ DFA.getDefinition(callInst) };
+				for (auto i = def; def != -1 && i < DFA.numDefinitions() && DFA.getInstruction(i) == callInst; i++) {
+					forEachAlias(DFA.getVariable(i), visit);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Computes which CAT variables have been read by a CAT_get since their last (re)definition,
+		/// on every path to the entry and exit of each block:
+		/// <para>IN = the intersection of the OUT SETs of the predecessors, OUT = GEN U (IN - KILL)</para>
+		/// </summary>
+		void computeAvailableGets(Function& F) {
+			auto numBlocks{ DFA.numBlocks() };
+			for (auto sets : { &avail_in, &avail_out, &avail_gen, &avail_kill }) {
+				sets->resize(numBlocks);
+				for (auto block = 0; block < numBlocks; block++) {
+					(*sets)[block].clear();
+					(*sets)[block].resize(read_index.size());
+				}
+			}
+			for (auto block = 0; block < numBlocks; block++) {
+				auto& gen{ avail_gen[block] };
+				auto& kill{ avail_kill[block] };
+				for (auto& I : *(DFA.getBlock(block))) {
+					forEachReadDefined(&I, [&](int var) {
+						gen.reset(var);
+						kill.set(var);
+					});
+					auto callInst{ dyn_cast<CallInst>(&I) };
+					if (callInst != nullptr && classify(callInst) == CAT_API::GET) {
+						gen.set(read_index[callInst->getArgOperand(0)]);
+					}
+				}
+				// Optimistically start with everything available, but the entry
+				if (block != DFA.getBlockIndex(&F.getEntryBlock())) { avail_out[block].set(); }
+			}
+			GEN_KILL_PROBLEM<true, true> problem{ avail_in, avail_out, avail_gen, avail_kill, DFA.getBlockIndex(&F.getEntryBlock()) };
+			solver.solve(F, DFA, problem);
+		}
+
+		/// <summary>
+		/// Removes every CAT_get call whose CAT variable has already been read by a CAT_get on every
+		/// path to it, with no (re)definition in between. It is replaced by the result of those calls,
+		/// merged by PHIs where the paths join. Beforehand, a CAT_get whose CAT variable is only read on
+		/// some paths into its block is made fully redundant by reading it at the end of the other
+		/// predecessors, when they only lead to that block.
+		/// </summary>
+		/// <param name='F'>The function, after constant propagation and folding.</param>
+		/// <param name='DT'>The dominator tree of the function.</param>
+		/// <returns>true if any CAT_get was removed or inserted, false otherwise.</returns>
+		bool eliminateRedundantGets(Function& F, DominatorTree& DT) {
+			read_index.clear();
+			std::vector<Value*> reads;
+			for (auto block = 0; block < DFA.numBlocks(); block++) {
+				for (auto& I : *(DFA.getBlock(block))) {
+					auto callInst{ dyn_cast<CallInst>(&I) };
+					if (callInst == nullptr || classify(callInst) != CAT_API::GET) { continue; }
+					if (read_index.insert(std::make_pair(callInst->getArgOperand(0), (int)reads.size())).second) {
+						reads.push_back(callInst->getArgOperand(0));
+					}
+				}
+			}
+			if (reads.empty()) { return false; }
+			computeAvailableGets(F);
+
+			/* Partial redundancy */
+			auto& ctx{ F.getContext() };
+			auto inserted{ false };
+			BitVector exposed(reads.size());
+			for (auto block = 0; block < DFA.numBlocks(); block++) {
+				auto J{ DFA.getBlock(block) };
+				// The CAT variables read in this block before any (re)definition
+				exposed.reset();
+				BitVector defined(reads.size());
+				for (auto& I : *J) {
+					auto callInst{ dyn_cast<CallInst>(&I) };
+					if (callInst != nullptr && classify(callInst) == CAT_API::GET) {
+						auto var{ read_index[callInst->getArgOperand(0)] };
+						if (!defined.test(var)) { exposed.set(var); }
+					}
+					forEachReadDefined(&I, [&](int var) { defined.set(var); });
+				}
+				exposed.reset(avail_in[block]);
+				for (auto var : exposed.set_bits()) {
+					auto some{ false };
+					auto all{ true };
+					for (auto P : predecessors(J)) {
+						auto pred{ DFA.getBlockIndex(P) };
+						if (pred == -1) { continue; }
+						if (avail_out[pred].test(var)) { some = true; }
+						// Reading it at the end of P must not add a read to paths avoiding J
+						else if (P->getSingleSuccessor() != J) { all = false; }
+						// The handle must exist there
+						else if (auto handle = dyn_cast<Instruction>(reads[var])) {
+							all &= DT.dominates(handle, P->getTerminator());
+						}
+					}
+					if (!some || !all) { continue; }
+					for (auto P : predecessors(J)) {
+						auto pred{ DFA.getBlockIndex(P) };
+						if (pred == -1 || avail_out[pred].test(var)) { continue; }
+						CallInst::Create(declare(CAT_API::GET, ctx), { reads[var] }, "", P->getTerminator());
+						NumGetsInserted++;
+						inserted = true;
+					}
+				}
+			}
+			if (inserted) { computeAvailableGets(F); }
+
+			/* Full redundancy */
+			auto removed{ false };
+			std::vector<std::pair<CallInst*, Value*>> replacements;
+			for (auto var = 0; var < reads.size(); var++) {
+				SSAUpdater SSA;
+				SSA.Initialize(IntegerType::get(ctx, 64), "");
+				// The value available at the end of a block is the first CAT_get after its last
+				// (re)definition, unless its CAT variable was already available on entry
+				for (auto block = 0; block < DFA.numBlocks(); block++) {
+					auto available{ avail_in[block].test(var) };
+					CallInst* first{ nullptr };
+					for (auto& I : *(DFA.getBlock(block))) {
+						forEachReadDefined(&I, [&](int v) {
+							if (v == var) {
+								available = false;
+								first = nullptr;
 							}
+						});
+						auto callInst{ dyn_cast<CallInst>(&I) };
+						if (callInst == nullptr || classify(callInst) != CAT_API::GET || read_index[callInst->getArgOperand(0)] != var) { continue; }
+						if (!available && first == nullptr) { first = callInst; }
+					}
+					if (first != nullptr) { SSA.AddAvailableValue(DFA.getBlock(block), first); }
+				}
+				// Every other CAT_get of this CAT variable reads an available value
+				for (auto block = 0; block < DFA.numBlocks(); block++) {
+					auto B{ DFA.getBlock(block) };
+					Value* current{ nullptr };
+					auto entry{ avail_in[block].test(var) };
+					for (auto& I : *B) {
+						auto callInst{ dyn_cast<CallInst>(&I) };
+						if (callInst != nullptr && classify(callInst) == CAT_API::GET && read_index[callInst->getArgOperand(0)] == var) {
+							if (current == nullptr && entry) { current = SSA.GetValueInMiddleOfBlock(B); }
+							if (current != nullptr) { replacements.push_back(std::make_pair(callInst, current)); }
+							else { current = callInst; }
 						}
+						forEachReadDefined(&I, [&](int v) {
+							if (v == var) {
+								current = nullptr;
+								entry = false;
+							}
+						});
+					}
+				}
+			}
+			// The values replacing the CAT_get calls are never removed themselves, but PHIs may use them
+			for (auto& replacement : replacements) {
+				replacement.first->replaceAllUsesWith(replacement.second);
+			}
+			for (auto& replacement : replacements) {
+				replacement.first->eraseFromParent();
+				NumRedundantGets++;
+				removed = true;
+			}
+			return removed || inserted;
+		}
+
+		/// <summary>
+		/// Finds the CAT variables a CAT API call reads, and the one it (re)defines.
+		/// <para>Only the CAT variables marked in <c>tracked</c> are reported, the others are -1.</para>
+		/// </summary>
+		/// <returns>The number of CAT variables read.</returns>
+		int accesses(CallInst* callInst, const BitVector& tracked, int& defined, int (&read)[2]) {
+			auto varOf = [&](Value* V) {
+				auto var{ DFA.getVariableIndex(V) };
+				return var != -1 && tracked.test(var) ? var : -1;
+			};
+			defined = -1;
+			switch (classify(callInst)) {
+			case CAT_API::NEW:
+				defined = varOf(callInst);
+				return 0;
+			case CAT_API::SET:
+				defined = varOf(callInst->getArgOperand(0));
+				return 0;
+			case CAT_API::GET:
+				read[0] = varOf(callInst->getArgOperand(0));
+				return 1;
+			case CAT_API::ADD:
+			case CAT_API::SUB:
+				defined = varOf(callInst->getArgOperand(0));
+				read[0] = varOf(callInst->getArgOperand(1));
+				read[1] = varOf(callInst->getArgOperand(2));
+				return 2;
+			default:
+				return 0;
+			}
+		}
+
+		/// <summary>
+		/// Removes the CAT_set, CAT_add and CAT_sub calls whose CAT variable is (re)defined again
+		/// before it is read, with a backward liveness analysis over the CAT variables that never
+		/// escape their function. A block's KILL is the set of CAT variables it (re)defines, as
+		/// in the reaching definitions, and its USE the set it reads before (re)defining them.
+		/// CAT_new calls left without any use are removed too.
+		/// </summary>
+		/// <param name='F'>The function, after constant propagation and folding.</param>
+		/// <returns>true if any definition was removed, false otherwise.</returns>
+		bool eliminateDeadDefinitions(Function& F) {
+			// Only CAT variables that never escape have all of their reads visible
+			BitVector tracked(DFA.numVariables());
+			for (auto def = 0; def < DFA.numDefinitions(); def++) {
+				auto newInst{ dyn_cast<CallInst>(DFA.getVariable(def)) };
+				if (newInst != nullptr && classify(newInst) == CAT_API::NEW && isPromotable(newInst)) {
+					tracked.set(DFA.getVariableIndex(def));
+				}
+			}
+			if (tracked.none()) { return false; }
+
+			// The IR has been rewritten since Pass 1, so the calls are scanned again
+			int defined;
+			int read[2];
+			auto numBlocks{ DFA.numBlocks() };
+			for (auto sets : { &live_in, &live_out, &live_use, &live_kill }) {
+				sets->resize(numBlocks);
+				for (auto block = 0; block < numBlocks; block++) {
+					(*sets)[block].clear();
+					(*sets)[block].resize(DFA.numVariables());
+				}
+			}
+			for (auto block = 0; block < numBlocks; block++) {
+				auto& use{ live_use[block] };
+				auto& kill{ live_kill[block] };
+				for (auto iter = DFA.getBlock(block)->rbegin(); iter != DFA.getBlock(block)->rend(); iter++) {
+					auto callInst{ dyn_cast<CallInst>(&*iter) };
+					if (callInst == nullptr) { continue; }
+					auto reads{ accesses(callInst, tracked, defined, read) };
+					if (defined != -1) {
+						use.reset(defined);
+						kill.set(defined);
+					}
+					for (auto j = 0; j < reads; j++) {
+						if (read[j] != -1) { use.set(read[j]); }
+					}
+				}
+			}
+
+			// IN = USE U (OUT - KILL), OUT = U IN of the successors
+			GEN_KILL_PROBLEM<false, false> problem{ live_out, live_in, live_use, live_kill, -1 };
+			solver.solve(F, DFA, problem);
+
+			// A definition is dead if its CAT variable is not live right after it
+			std::vector<Instruction*> dead;
+			BitVector live;
+			for (auto block = 0; block < numBlocks; block++) {
+				live = live_out[block];
+				for (auto iter = DFA.getBlock(block)->rbegin(); iter != DFA.getBlock(block)->rend(); iter++) {
+					auto callInst{ dyn_cast<CallInst>(&*iter) };
+					if (callInst == nullptr) { continue; }
+					auto reads{ accesses(callInst, tracked, defined, read) };
+					if (defined != -1) {
+						// The reads of a dead definition are gone with it
+						if (!live.test(defined) && classify(callInst) != CAT_API::NEW) {
+							dead.push_back(callInst);
+							continue;
+						}
+						live.reset(defined);
+					}
+					for (auto j = 0; j < reads; j++) {
+						if (read[j] != -1) { live.set(read[j]); }
+					}
+				}
+			}
+			for (auto I : dead) {
+				I->eraseFromParent();
+			}
+			NumDeadDefinitions += dead.size();
+
+			// CAT variables that are never read are now only created
+			auto removed{ !dead.empty() };
+			for (auto var = 0; var < DFA.numVariables(); var++) {
+				if (!tracked.test(var)) { continue; }
+				auto newInst{ cast<Instruction>(DFA.getVariable(DFA.getVariableDefinitions(var)[0])) };
+				if (newInst->use_empty()) {
+					newInst->eraseFromParent();
+					NumDeadDefinitions++;
+					removed = true;
+				}
+			}
+			return removed;
+		}
+
+		/// <summary>
+		/// Replaces every CAT variable that never escapes its function by an <c>i64</c> SSA value:
+		/// its CAT_new becomes a store to a stack slot, CAT_set, CAT_add and CAT_sub store to it,
+		/// and CAT_get loads from it. The stack slots are then promoted to registers, which places
+		/// PHIs where the definitions of a CAT variable merge.
+		/// </summary>
+		/// <param name='F'>The function, after constant propagation and folding.</param>
+		/// <param name='DT'>The dominator tree of the function.</param>
+		/// <returns>true if any CAT variable was promoted, false otherwise.</returns>
+		bool promoteVariables(Function& F, DominatorTree& DT) {
+			auto& ctx{ F.getContext() };
+			auto intType{ IntegerType::get(ctx, 64) };
+			DenseMap<const Value*, AllocaInst*> slots;
+			std::vector<AllocaInst*> allocas;
+			std::vector<CallInst*> calls;
+			IRBuilder<> builder(&*(F.getEntryBlock().getFirstInsertionPt()));
+			for (auto& B : F) {
+				for (auto& I : B) {
+					auto callInst{ dyn_cast<CallInst>(&I) };
+					if (callInst == nullptr) { continue; }
+					auto op{ classify(callInst) };
+					if (op == CAT_API::NEW) {
+						if (!isPromotable(callInst)) { continue; }
+						auto slot{ builder.CreateAlloca(intType) };
+						slots[callInst] = slot;
+						allocas.push_back(slot);
+						calls.push_back(callInst);
 					}
-					else if (auto storeInst = dyn_cast<StoreInst>(&I)) {
-						int memLoc;
-						for (auto i = 0; i < index; i++) {
-							if (DFA[i]->getInstruction() == storeInst->getPointerOperand()) {
-								memLoc = i;
-								break;
-							}
-						}
-						auto memInst = DFA[memLoc]->getInstruction();
-						for (auto i = 0; i < index; i++) {
-							auto tempInst = DFA[i]->getInstruction();
-							if (tempInst != storeInst->getValueOperand()) { continue; }
-							DFA[i]->add(memLoc, DFA_SET::ALIAS);
-							// errs() << *memInst << " aliases " << *tempInst << "\n";
-						}
+					else if (op == CAT_API::GET || op == CAT_API::SET || op == CAT_API::ADD || op == CAT_API::SUB) {
+						calls.push_back(callInst);
 					}
-					else if (auto loadInst = dyn_cast<LoadInst>(&I)) {
-						for (auto i = 0; i < index; i++) {
-							auto tempInst = DFA[i]->getInstruction();
-							if (isa<StoreInst>(tempInst) &&
-								loadInst->getPointerOperand() == cast<StoreInst>(tempInst)->getPointerOperand()) {
-								DFA[i]->add(index, DFA_SET::KILL);
-								p_dfa->add(i, DFA_SET::KILL);
-							}
-						}
+				}
+			}
+			if (allocas.empty()) { return false; }
+
+			// Reads a CAT variable before a call: from its stack slot, or through CAT_get if it escapes
+			auto read = [&](IRBuilder<>& builder, Value* V) -> Value* {
+				auto slot{ slots.lookup(V) };
+				if (slot != nullptr) { return builder.CreateLoad(intType, slot); }
+				return builder.CreateCall(declare(CAT_API::GET, ctx), { V });
+			};
+			// Writes a CAT variable before a call: to its stack slot, or through CAT_set if it escapes
+			auto write = [&](IRBuilder<>& builder, Value* V, Value* value) {
+				auto slot{ slots.lookup(V) };
+				if (slot != nullptr) { builder.CreateStore(value, slot); }
+				else { builder.CreateCall(declare(CAT_API::SET, ctx), { V, value }); }
+			};
+			// The CAT_new calls go last, once nothing uses them
+			std::stable_partition(calls.begin(), calls.end(), [&](CallInst* callInst) {
+				return classify(callInst) != CAT_API::NEW;
+			});
+			for (auto callInst : calls) {
+				auto op{ classify(callInst) };
+				auto touches{ op == CAT_API::NEW };
+				for (auto i = 0; i < (op == CAT_API::NEW ? 0 : callInst->getNumArgOperands()); i++) {
+					touches |= slots.count(callInst->getArgOperand(i)) != 0;
+				}
+				// Calls on escaping CAT variables only are left alone
+				if (!touches) { continue; }
+				IRBuilder<> builder(callInst);
+				switch (op) {
+				case CAT_API::NEW:
+					builder.CreateStore(callInst->getArgOperand(0), slots[callInst]);
+					break;
+				case CAT_API::SET:
+					write(builder, callInst->getArgOperand(0), callInst->getArgOperand(1));
+					break;
+				case CAT_API::GET:
+					callInst->replaceAllUsesWith(read(builder, callInst->getArgOperand(0)));
+					break;
+				case CAT_API::ADD:
+				case CAT_API::SUB: {
+					auto value1{ read(builder, callInst->getArgOperand(1)) };
+					auto value2{ read(builder, callInst->getArgOperand(2)) };
+					write(builder, callInst->getArgOperand(0), op == CAT_API::ADD ?
+						builder.CreateAdd(value1, value2) :
+						builder.CreateSub(value1, value2));
+					break;
+				}
+				default:
+					break;
+				}
+				callInst->eraseFromParent();
+			}
+			NumPromoted += allocas.size();
+			PromoteMemToReg(allocas, DT);
+			return true;
+		}
+
+		/// <summary>
+		/// Applies the identities that need no constants to the CAT_add and CAT_sub calls of a
+		/// function, which can give Pass 1 more constant definitions.
+		/// </summary>
+		/// <param name='F'>The function to simplify.</param>
+		/// <returns>Whether the function was changed.</returns>
+		bool presimplify(Function& F) {
+			simplifications.clear();
+			for (auto& B : F) {
+				for (auto& I : B) {
+					auto callInst{ dyn_cast<CallInst>(&I) };
+					if (callInst == nullptr) { continue; }
+					auto op{ classify(callInst) };
+					if (op == CAT_API::ADD || op == CAT_API::SUB) {
+						simplifications.push_back(std::make_pair(callInst, 0));
 					}
-					DFA.push_back(p_dfa);
-					index++;
 				}
 			}
+			return simplify();
+		}
 
-			/* Pass 2: IN/OUT */
-			bool first{ true };
-			bool out_has_changed{ false };
-			do {
-				index = 0;
-				out_has_changed = false;
-				for (auto& B : F) {
-					// Skip unreachable code
-					if (DT.getNode(&B) == NULL) { continue; }
-
-					first = true;
-					for (auto& I : B) {
-						auto p_dfa{ DFA[index] };
-						BitVector comp{ *(p_dfa->get_out()) };
-						// Generate IN set if this instruction has predecessors
-						// First check if this is a BasicBlock's entry point
-						if (first) {
-							// errs() << *(p_dfa->getInstruction()) << " preds: ";
-							for (auto B : predecessors(&B)) {
-								// Find DFA of predecessor BasicBlock's terminator Instruction
-								for (auto i = 0; i < DFA.size(); i++) {
-									if (DFA[i]->getInstruction() == B->getTerminator()) {
-										// errs() << i << " ";
-										// Add the OUT set of the predecessor to this Instruction's IN set
-										p_dfa->add(DFA[i]->get_out(), DFA_SET::IN);
-									}
-								}
-							}
-							// errs() << "\n";
-						}
-						// If not, then just get the previous instruction
-						else {
-							// Add the OUT set of the predecessor to this Instruction's IN set
-							p_dfa->add(DFA[index - 1]->get_out(), DFA_SET::IN);
-						}
-						// Generate OUT set as a function of this Instruction's other sets
-						p_dfa->add(p_dfa->get_gen(), DFA_SET::OUT);
-						BitVector set_diff{ *(p_dfa->get_in()) };
-						set_diff ^= *(p_dfa->get_kill());
-						set_diff &= *(p_dfa->get_in());
-						p_dfa->add(&set_diff, DFA_SET::OUT);
-
-						if (comp != *(p_dfa->get_out())) {
-							out_has_changed = true;
-						}
+		/// <summary>
+		/// Finds the constant propagations and foldings of a function (Pass 1 to 3), and the
+		/// simplifications they enable. Only reads the IR; the rewrites are made by <c>transform</c>.
+		/// </summary>
+		/// <param name='F'>The function to analyze.</param>
+		/// <param name='DT'>The dominator tree of the function, used to check for unreachable code.</param>
+		/// <param name='AA'>The alias analysis of the function.</param>
+		void analyze(Function& F, DominatorTree& DT, AAResults& AA) {
+			findDefinitions(F, DT, AA);
+			propagations.clear();
+			foldings.clear();
+			simplifications.clear();
+			if (UseSCCP) {
+				solveSCCP(F, DT);
+			}
+			else {
+				solveReachingDefinitions(F);
+			}
+		}
 
-						index++;
-						first = false;
+		/// <summary>Finds the reaching definitions of a function and the value of each definition (Pass 1 and 2), without Pass 3.</summary>
+		/// <param name='F'>The function to analyze.</param>
+		/// <param name='DT'>The dominator tree of the function, used to check for unreachable code.</param>
+		/// <param name='AA'>The alias analysis of the function.</param>
+		void analyzeReachingDefinitions(Function& F, DominatorTree& DT, AAResults& AA) {
+			findDefinitions(F, DT, AA);
+			solveDefinitions(F);
+		}
+
+		/// <summary>Finds the definitions of the CAT variables of a function (Pass 1).</summary>
+		/// <param name='F'>The function to analyze.</param>
+		/// <param name='DT'>The dominator tree of the function, used to check for unreachable code.</param>
+		/// <param name='AA'>The alias analysis of the function.</param>
+		void findDefinitions(Function& F, DominatorTree& DT, AAResults& AA) {
+			// Forget the previous function, but keep its memory
+			DFA.clear();
+			modref_cache.clear();
+			auto& escaping{ DFA.escaping };
+
+			// Storing a CAT variable makes it escape, and calls may then (re)define it through
+			// memory wherever they are; a store can follow a call in the layout and still reach
+			// it around a loop, so every escaping CAT variable is found before any call is classified
+			for (auto& B : F) {
+				// Skip unreachable code
+				if (DT.getNode(&B) == NULL) { continue; }
+
+				for (auto& I : B) {
+					if (auto storeInst = dyn_cast<StoreInst>(&I)) {
+						auto valueOperand = storeInst->getValueOperand();
+						if (valueOperand->getType()->isPointerTy()) {
+							escaping.insert(valueOperand);
+						}
 					}
 				}
-			} while (out_has_changed);
+			}
 
-			// for (auto p_dfa : DFA) { p_dfa->print(&DFA); }
+			// A (re)definition through a handle may (re)define the CAT variable of any handle merged with it by a PHI
+			computePhiAliases(F, DT);
 
-			/* Pass 3: Constant Propagation, Constant Folding */
-			index = 0;
-			std::map<Instruction*, Value*> propagations;
-			std::map<Instruction*, int> foldings;
+			/* Pass 1: GEN/KILL */
+			// Only Instructions that can (re)define a CAT variable are given a position in
+			// the SETs; every other Instruction has the identity transfer function.
+			// Each definition KILLs every other definition of the same CAT variable, so
+			// KILL is derived from the definitions of each variable instead of comparing every pair of definitions
 			for (auto& B : F) {
 				// Skip unreachable code
 				if (DT.getNode(&B) == NULL) { continue; }
 
+				DFA.addBlock(&B);
 				for (auto& I : B) {
-					auto p_dfa{ DFA[index] };
-					// We're only interested in Call Instructions
-					if (auto callInst = dyn_cast<CallInst>(p_dfa->getInstruction())) {
-						auto f_name{ callInst->getCalledFunction()->getName() };
-						/* Constant Propagation */
-						// errs() << "\n" << *callInst << "\n";
-						Value* arg;
-						bool can_prop{ true };
-						bool valset{ false };
-						ConstantInt* val{ nullptr };
-						// We're only interested in calls to CAT_get, since that can be converted to a constant int
-						if (f_name != "CAT_get") { goto CONST_PROP; }
-						arg = callInst->getArgOperand(0);
-						// Iterate through the IN set
-						for (int i = 0; i < p_dfa->get_in()->size(); i++) {
-							if (!(*(p_dfa->get_in()))[i]) { continue; }
-							// errs() << ">" << *(DFA[i]->getInstruction());
-							if (auto c_val = definesAsConstant(DFA[i]->getInstruction(), arg)) {
-								// errs() << " defines callInst as a constant\n";
-								// Ensure all reaching definitions set v to the same constant c
-								if (!valset) {
-									valset = true;
-									val = c_val;
-								}
-								else if (val->getSExtValue() != c_val->getSExtValue()) {
-									can_prop = false;
-									goto CONST_PROP;
-								}
-							}
-							else if (defines(DFA[i]->getInstruction(), arg, AA)) {
-								// A definition was not constant
-								// errs() << " defines callInst\n";
-								can_prop = false;
-								goto CONST_PROP;
-							}
-							else {
-								// errs() << " does NOT define callInst\n";
-								;
-							}
+					if (auto callInst = dyn_cast<CallInst>(&I)) {
+						auto op{ classify(callInst) };
+						// Initial definition of a CAT variable
+						//  %1 = tail call i8* @CAT_new(i64 5) #3
+						if (op == CAT_API::NEW) {
+							DFA.addDefinition(callInst, callInst);
 						}
-					CONST_PROP:
-						if (can_prop && valset) {
-							// The constant propagation is valid, all reaching definitions are the same constant value
-							propagations.insert(std::pair<Instruction*, Value*>(callInst, val));
+						// Redefinitions of a CAT variable
+						//  tail call void @CAT_set(i8* %1, i64 42) #3
+						else if (op == CAT_API::SET || op == CAT_API::ADD || op == CAT_API::SUB) {
+							auto V{ callInst->getArgOperand(0) };
+							DFA.addDefinition(callInst, V);
+							// The handles merged with V by a PHI may name the same CAT variable, or not,
+							// so their value is unknown afterwards, as after a call that may modify them
+							forEachAlias(V, [&](Value* A) {
+								if (A != V) { DFA.addDefinition(callInst, A); }
+							});
 						}
-						/* Constant Folding */
-						bool both_consts{ true };
-						bool val1set{ false };
-						bool val2set{ false };
-						int val1{ 0 };
-						int val2{ 0 };
-						// We're only interested in calls to CAT_add and CAT_sub, since those can be converted to CAT_set
-						if (f_name != "CAT_add" && f_name != "CAT_sub") { goto CONST_FOLD; }
-						// errs() << *callInst;
-						// Check both args 1 and 2
-						for (auto arg = 1; arg <= 2; arg++) {
-							auto binOpArg = callInst->getArgOperand(arg);
-							// Iterate through the IN set
-							for (int i = 0; i < p_dfa->get_in()->size(); i++) {
-								if (!(*(p_dfa->get_in()))[i]) { continue; }
-								// errs() << "\n\t" << *(DFA[i]->getInstruction()) << "\n\t> ";
-								// Check if the instruction in the IN set defines the argument
-								if (auto c_val = definesAsConstant(DFA[i]->getInstruction(), binOpArg)) {
-									// errs() << "defines callInst's arg " << arg << " as a constant";
-									// Ensure all reaching definitions set v to the SAME constant c
-									switch (arg) {
-									case 1:
-										if (!val1set) {
-											val1 = c_val->getSExtValue();
-											val1set = true;
-										}
-										else if (val1 != c_val->getSExtValue()) {
-											both_consts = false;
-											goto CONST_FOLD;
-										}
-										break;
-									case 2:
-										if (!val2set) {
-											val2 = c_val->getSExtValue();
-											val2set = true;
-										}
-										else if (val2 != c_val->getSExtValue()) {
-											both_consts = false;
-											goto CONST_FOLD;
-										}
-										break;
-									}
-								}
-								else if (defines(DFA[i]->getInstruction(), binOpArg, AA)) {
-									// errs() << "does not define callInst's arg " << arg << "  as a constant";
-									// At least one argument has a non-constant definition
-									both_consts = false;
-									goto CONST_FOLD;
+						// Check if a non-CAT API function kills a CAT variable
+						else if (op == CAT_API::CALL) {
+							SmallSetVector<Value*, 8> modified;
+							// Non-CAT API function calls require memory alias analysis
+							// If a function Mods a CAT variable or any of its aliases,
+							// it KILLs that variable's definition. If there is no MOD,
+							// the CAT variable is unaffected
+							for (auto var : escaping) {
+								// Make sure this function call modifies the CAT variable
+								if (mods(getModRefInfo(callInst, var, AA))) {
+									modified.insert(var);
 								}
-								else {
-									// errs() << "does not define callInst's arg " << arg;
-									;
+							}
+							// The call also (re)defines any CAT variable it is passed and may modify
+							for (auto j = 0; j < callInst->getNumArgOperands(); j++) {
+								auto argOperand = callInst->getArgOperand(j);
+								if (modified.count(argOperand)) { continue; }
+								if (argOperand->getType()->isPointerTy() && defines(callInst, argOperand, AA)) {
+									modified.insert(argOperand);
 								}
 							}
+							// And so does it through every handle merged with one of them by a PHI
+							for (auto k = 0; k < modified.size(); k++) {
+								forEachAlias(modified[k], [&](Value* A) { modified.insert(A); });
+							}
+							for (auto var : modified) {
+								DFA.addDefinition(callInst, var);
+							}
 						}
-						// errs() << "\n";
-					CONST_FOLD:
-						if (both_consts && val1set && val2set) {
-							// The constant folding is valid, both operands are constants
-							// errs() << "> Folding to " << "CAT_set(" << (f_name == "CAT_add" ? val1 + val2 : val1 - val2) << ")\n";
-							foldings.insert(std::pair<Instruction*, int>(callInst, (f_name == "CAT_add" ? val1 + val2 : val1 - val2)));
+					}
+					else if (auto phiInst = dyn_cast<PHINode>(&I)) {
+						// Only PHIs of CAT variables are definitions
+						if (phiInst->getType()->isPointerTy()) {
+							DFA.addDefinition(phiInst, phiInst);
 						}
 					}
-					index++;
 				}
 			}
 
-			// Go through the mapping of constant propagations and do them
-			for (auto prop_iter = propagations.begin(); prop_iter != propagations.end(); prop_iter++) {
-				// errs() << "CP: Replacing" << *(prop_iter->first) << " with " << *(prop_iter->second) << "\n";
-				BasicBlock::iterator ii(prop_iter->first);
-				ReplaceInstWithValue(prop_iter->first->getParent()->getInstList(), ii, prop_iter->second);
-				has_modified_code = true;
+			DFA.finalize();
+		}
+
+		/// <summary>
+		/// Collects the definitions of a CAT variable reaching a program point: the last one before
+		/// the point in its block if there is one, or else the ones reaching the start of the block.
+		/// </summary>
+		/// <param name='V'>The CAT variable.</param>
+		/// <param name='point'>The program point, whose own definitions do not reach it.</param>
+		/// <param name='defs'>Where to add the definitions reaching the point.</param>
+		void reachingDefinitions(const Value* V, const Instruction* point, SmallVectorImpl<int>& defs) {
+			auto block{ DFA.getBlockIndex(point->getParent()) };
+			auto var{ DFA.getVariableIndex(V) };
+			// Nothing reaches unreachable code
+			if (block == -1 || var == -1) { return; }
+			auto last{ -1 };
+			for (auto& I : *(point->getParent())) {
+				if (&I == point) { break; }
+				auto def{ DFA.getDefinition(&I) };
+				if (def == -1) { continue; }
+				for (auto i = def; i < DFA.numDefinitions() && DFA.getInstruction(i) == &I; i++) {
+					if (DFA.getVariableIndex(i) == var) { last = i; }
+				}
+			}
+			if (last != -1) {
+				defs.push_back(last);
+				return;
+			}
+			auto var_defs{ DFA.getVariableDefinitions(var) };
+			if (!UseSlices) {
+				auto in{ DFA.getSet(block, DFA_STATE::IN) };
+				for (auto i : var_defs) {
+					if (DFA.test(in, i)) { defs.push_back(i); }
+				}
+				return;
+			}
+			auto iter{ SLICES.row_index.find(std::make_pair(var, block)) };
+			if (iter == SLICES.row_index.end()) { return; }
+			for (auto k = 0; k < var_defs.size(); k++) {
+				if (DFA.test(&SLICES.words[iter->second], k)) { defs.push_back(var_defs[k]); }
+			}
+		}
+
+		/// <summary>Computes the value of a CAT variable at a program point from the definitions reaching it.</summary>
+		/// <param name='V'>The CAT variable.</param>
+		/// <param name='point'>The program point.</param>
+		/// <returns>The meet of the values of the definitions of <c>V</c> reaching the point, NONCONSTANT if there are none.</returns>
+		LATTICE_VALUE valueAt(const Value* V, const Instruction* point) {
+			SmallVector<int, 4> defs;
+			reachingDefinitions(V, point, defs);
+			LATTICE_VALUE value;
+			for (auto i : defs) {
+				value.meet(constants[i]);
 			}
+			return defs.empty() ? LATTICE_VALUE(nullptr) : value;
+		}
 
-			// Go through the mapping of constant foldings and do them
-			for (auto fold_iter = foldings.begin(); fold_iter != foldings.end(); fold_iter++) {
-				IRBuilder<> builder(fold_iter->first->getParent());
-				FunctionCallee f{
-					mod->getOrInsertFunction(
-						/* function name */
-						"CAT_set",
-						/* return type */
-						Type::getVoidTy(ctx),
-						/* args */
-						PointerType::get(IntegerType::get(ctx, 8), 0),
-						IntegerType::get(ctx, 64)
-						)
-				};
-				std::vector<Value*> params{
-					/* param 0: CAT variable */
-					cast<CallInst>(fold_iter->first)->getArgOperand(0),
-					/* param 1: int */
-					ConstantInt::get(ctx, APInt(64, fold_iter->second, true))
-				};
-				// errs() << "CF: Replacing" << *(fold_iter->first) << " with CAT_set(" << fold_iter->second << ");\n";
-				ReplaceInstWithInst(fold_iter->first, CallInst::Create(f, params));
-				has_modified_code = true;
+		/// <summary>Gets the Instruction of a definition.</summary>
+		Instruction* getDefinition(int def) const {
+			return DFA.getInstruction(def);
+		}
+
+		/// <summary>Rewrites a function with the results of <c>analyze</c>, then runs the enabled transformations.</summary>
+		/// <param name='F'>The function analyzed last.</param>
+		/// <param name='DT'>The dominator tree of the function.</param>
+		/// <param name='LI'>The loops of the function, if <c>-cat-indvars</c> or <c>-cat-licm</c> is enabled.</param>
+		/// <param name='SE'>The scalar evolution of the function, if <c>-cat-indvars</c> is enabled.</param>
+		/// <returns>Whether the function was changed.</returns>
+		bool transform(Function& F, DominatorTree& DT, LoopInfo* LI, ScalarEvolution* SE) {
+			// Used to keep track of whether our pass has modified anything
+			bool has_modified_code{ false };
+			// Reusable context variable
+			auto& ctx{ F.getContext() };
+
+			// SCCP already sees through the constants its own rewrites would create
+			auto fixpoint{ UseFixpoint && !UseSCCP };
+			SmallVector<int, 16> changed;
+			has_modified_code |= applyRewrites(ctx, fixpoint ? &changed : nullptr);
+			if (fixpoint) {
+				has_modified_code |= propagateToFixpoint(ctx, changed);
+			}
+
+			// Identities needing the constants found above
+			has_modified_code |= simplify();
+
+			if (UseRedundantGets) {
+				has_modified_code |= eliminateRedundantGets(F, DT);
 			}
 
-			// Release memory
-			for (auto p_dfa : DFA) { delete p_dfa; }
+			if (UseInductionVariables) {
+				has_modified_code |= rewriteInductionVariables(*LI, DT, *SE);
+			}
+			if (UseHoisting) {
+				has_modified_code |= hoistLoopInvariants(*LI, DT);
+			}
+			if (UseDeadDefinitions) {
+				has_modified_code |= eliminateDeadDefinitions(F);
+			}
+			if (UsePromotion) {
+				has_modified_code |= promoteVariables(F, DT);
+			}
 
 			return has_modified_code;
 		}
 
-		// We don't modify the program, so we preserve all analyses.
-		// The LLVM IR of functions isn't ready at this point
+	private:
+		// The CAT API of the module the function belongs to
+		CAT_MODULE& module;
+		// The mod/ref behaviour of each (call, CAT variable) pair already asked to alias analysis
+		DenseMap<std::pair<const CallInst*, const Value*>, ModRefInfo> modref_cache;
+		// The dataflow state of the current function, reused by every function
+		DFA_STATE DFA;
+		// The dataflow solver, reused by every problem of every function
+		DFA_SOLVER solver;
+		// The lattice value of each definition, and the PHI definitions left to (re)compute
+		std::vector<LATTICE_VALUE> constants;
+		std::vector<int> phi_worklist;
+		BitVector phi_queued;
+		// Rewrites to apply to the current function
+		std::vector<std::pair<Instruction*, Value*>> propagations;
+		std::vector<std::pair<Instruction*, int64_t>> foldings;
+		// CAT_add and CAT_sub calls to simplify, and which of their operands are known to be 0
+		std::vector<std::pair<CallInst*, int>> simplifications;
+		// The state of the SCCP engine, reused by every function
+		SCCP_STATE SCCP;
+		// The reaching definitions of each CAT variable, reused by every function
+		SLICE_STATE SLICES;
+		// Liveness of the CAT variables at the entry and exit of each block, and the
+		// CAT variables each block reads before (re)defining them, and (re)defines
+		std::vector<BitVector> live_in;
+		std::vector<BitVector> live_out;
+		std::vector<BitVector> live_use;
+		std::vector<BitVector> live_kill;
+		// The CAT variables read by CAT_get, and the CAT_get calls available at the entry and exit
+		// of each block, generated by each block, and KILLed by each block
+		DenseMap<const Value*, int> read_index;
+		std::vector<BitVector> avail_in;
+		std::vector<BitVector> avail_out;
+		std::vector<BitVector> avail_gen;
+		std::vector<BitVector> avail_kill;
+		// The number of definitions of each CAT variable in the loop being rewritten
+		std::vector<int> loop_defs;
+		// The handles merged by pointer PHIs: the group of each handle, and the handles of group g,
+		// alias_members[alias_begin[g] ... alias_begin[g + 1] - 1]
+		DenseMap<const Value*, int> alias_group;
+		std::vector<Value*> alias_values;
+		std::vector<int> alias_parent;
+		std::vector<int> alias_begin;
+		std::vector<Value*> alias_members;
+	};
+
+	/// <summary>
+	/// This pass holds the analyses of a function the CAT pass needs. The CAT pass asks for it
+	/// on the fly, and only for the functions calling the CAT API, so the analyses of the other
+	/// functions of a module are never computed.
+	/// </summary>
+	struct CAT_ANALYSES : public FunctionPass {
+		static char ID;
+
+		CAT_ANALYSES() : FunctionPass(ID) {}
+
+		bool runOnFunction(Function& F) override {
+			DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+			AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
+			LI = UseInductionVariables || UseHoisting ? &getAnalysis<LoopInfoWrapperPass>().getLoopInfo() : nullptr;
+			SE = UseInductionVariables ? &getAnalysis<ScalarEvolutionWrapperPass>().getSE() : nullptr;
+			return false;
+		}
+
+		// Loops are only needed by -cat-indvars and -cat-licm, and scalar evolution by -cat-indvars
 		void getAnalysisUsage(AnalysisUsage& AU) const override {
 			AU.addRequired<DominatorTreeWrapperPass>();
 			AU.addRequired<AAResultsWrapperPass>();
+			if (UseInductionVariables || UseHoisting) {
+				AU.addRequired<LoopInfoWrapperPass>();
+			}
+			if (UseInductionVariables) {
+				AU.addRequired<ScalarEvolutionWrapperPass>();
+			}
 			AU.setPreservesAll();
 		}
+
+		// The analyses of the function it last ran on; LI and SE are nullptr when not required
+		DominatorTree* DT{ nullptr };
+		AAResults* AA{ nullptr };
+		LoopInfo* LI{ nullptr };
+		ScalarEvolution* SE{ nullptr };
+	};
+
+	struct CAT : public ModulePass {
+		static char ID;
+
+		CAT() : ModulePass(ID), state(module) {}
+
+		// This function is invoked once per module compiled
+		// The LLVM IR of the input functions is ready and it can be analyzed and/or transformed
+		bool runOnModule(Module& M) override {
+			module.initialize(M);
+			// Used to keep track of whether our pass has modified anything
+			bool has_modified_code{ false };
+			for (auto& F : M) {
+				if (F.isDeclaration()) { continue; }
+				// Skip functions that never call the CAT API before asking for any analysis
+				if (!module.cat_functions.count(&F)) {
+					NumFunctionsSkipped++;
+					continue;
+				}
+				if (UseSimplification) {
+					has_modified_code |= state.presimplify(F);
+				}
+				// The analyses of this function alone are computed here
+				auto& analyses{ getAnalysis<CAT_ANALYSES>(F) };
+				state.analyze(F, *analyses.DT, *analyses.AA);
+				has_modified_code |= state.transform(F, *analyses.DT, analyses.LI, analyses.SE);
+			}
+			return has_modified_code;
+		}
+
+	private:
+		// The CAT API of the current module
+		CAT_MODULE module;
+		// The analyses of the current function, reused by every function
+		CAT_FUNCTION state;
+
+	public:
+		// We only rewrite, insert and remove instructions, and never change the CFG,
+		// so only the analyses of the CFG are preserved.
+		void getAnalysisUsage(AnalysisUsage& AU) const override {
+			AU.addRequired<CAT_ANALYSES>();
+			AU.setPreservesCFG();
+		}
+	};
+
+	/// <summary>
+	/// This struct schedules tasks over a number of workers. The tasks are dealt round-robin in
+	/// decreasing size, so every worker gets a similar share, and each queue is then sorted by task.
+	/// Each worker takes the next task from the front of its own queue, and once it is empty steals
+	/// from the back of another worker's queue. A worker thus only ever holds a task lower than all
+	/// of those left in its own queue, so the lowest task not done yet is always held by a worker or
+	/// left to be taken, and workers waiting for the tasks before theirs to be done cannot deadlock.
+	/// </summary>
+	struct WORK_QUEUES {
+	public:
+		/// <param name='workers'>The number of workers.</param>
+		/// <param name='sizes'>The size of each task.</param>
+		WORK_QUEUES(unsigned workers, ArrayRef<unsigned> sizes) : queues(workers), locks(new std::mutex[workers]) {
+			std::vector<int> order(sizes.size());
+			std::iota(order.begin(), order.end(), 0);
+			std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return sizes[a] > sizes[b]; });
+			for (auto i = 0; i < order.size(); i++) {
+				queues[i % workers].push_back(order[i]);
+			}
+			for (auto& queue : queues) {
+				std::sort(queue.begin(), queue.end());
+			}
+		}
+
+		/// <summary>Takes the next task of a worker, stealing one if the worker has none left.</summary>
+		/// <param name='worker'>The worker.</param>
+		/// <param name='task'>Set to the task taken.</param>
+		/// <returns>Whether a task was taken; once every queue is empty no task is ever added again.</returns>
+		bool pop(unsigned worker, int& task) {
+			{
+				std::lock_guard<std::mutex> lock(locks[worker]);
+				if (!queues[worker].empty()) {
+					task = queues[worker].front();
+					queues[worker].pop_front();
+					return true;
+				}
+			}
+			for (auto k = 1; k < queues.size(); k++) {
+				auto victim{ (worker + k) % queues.size() };
+				std::lock_guard<std::mutex> lock(locks[victim]);
+				if (!queues[victim].empty()) {
+					task = queues[victim].back();
+					queues[victim].pop_back();
+					return true;
+				}
+			}
+			return false;
+		}
+
+	private:
+		std::vector<std::deque<int>> queues;
+		std::unique_ptr<std::mutex[]> locks;
+	};
+
+	/// <summary>
+	/// This struct holds what the main thread prepares for a function before a worker analyzes it.
+	/// Scanning a function for assumptions registers value handles in the context, which workers
+	/// must not do, so the assumptions of a function are scanned here, and only kept if there are any;
+	/// the worker scans a function without any again, which registers nothing.
+	/// </summary>
+	struct CAT_TASK {
+	public:
+		CAT_TASK(Function& F, const TargetLibraryInfo& TLI) : F(F), TLI(TLI) {
+			std::unique_ptr<AssumptionCache> cache(new AssumptionCache(F));
+			if (!cache->assumptions().empty()) { AC = std::move(cache); }
+		}
+
+		Function& F;
+		TargetLibraryInfo TLI;
+		// The assumptions of the function, or nullptr if it has none
+		std::unique_ptr<AssumptionCache> AC;
+	};
+
+	/// <summary>
+	/// This struct holds the state of a worker of CAT_PARALLEL, reused by every function it analyzes
+	/// just like the state of the CAT pass, so memory does not grow with the number of functions.
+	/// </summary>
+	struct CAT_WORKER {
+	public:
+		CAT_WORKER(CAT_MODULE& module) : state(module) {}
+
+		DominatorTree DT;
+		CAT_FUNCTION state;
+	};
+
+	/// <summary>
+	/// This pass runs the CAT pass over a whole module, analyzing its functions on several threads
+	/// at once. Each worker commits the rewrites of the function it analyzed under a lock, in the
+	/// order of the module, then moves on to its next function, so the functions are rewritten in
+	/// the same order as by the CAT pass.
+	/// The CAT API functions rewrites may call are declared up front, since workers classify calls
+	/// by them, and removed at the end if unused; the module is then the same as after the CAT pass,
+	/// but for the order of those declarations when both are used.
+	/// SCCP creates constants in the shared context, so under <c>-cat-sccp</c> the functions are
+	/// analyzed while committing instead.
+	/// <para>
+	/// Analyses: the CAT pass gets those of a function from <c>CAT_ANALYSES</c>, which the legacy pass
+	/// manager runs in a function pass manager of its own. That one only holds the passes it is asked
+	/// for, so its alias analysis is basic alias analysis alone, whatever other alias analyses the
+	/// pipeline has, over a target library info built for no target. Each worker builds the same.
+	/// </para>
+	/// </summary>
+	struct CAT_PARALLEL : public ModulePass {
+		static char ID;
+
+		CAT_PARALLEL() : ModulePass(ID) {}
+
+		bool runOnModule(Module& M) override {
+			module.initialize(M);
+			// Used to keep track of whether our pass has modified anything
+			bool has_modified_code{ false };
+			// The library functions known to the analyses of the CAT pass
+			TargetLibraryInfoImpl library;
+			std::vector<std::unique_ptr<CAT_TASK>> tasks;
+			std::vector<unsigned> sizes;
+			for (auto& F : M) {
+				if (F.isDeclaration()) { continue; }
+				// Skip functions that never call the CAT API
+				if (!module.cat_functions.count(&F)) {
+					NumFunctionsSkipped++;
+					continue;
+				}
+				tasks.emplace_back(new CAT_TASK(F, TargetLibraryInfo(library, &F)));
+				sizes.push_back(F.getInstructionCount());
+			}
+			if (tasks.empty()) { return false; }
+
+			unsigned numWorkers{ Threads == 0 ? std::thread::hardware_concurrency() : Threads };
+			numWorkers = std::max(1u, std::min<unsigned>(numWorkers, tasks.size()));
+			std::vector<std::unique_ptr<CAT_WORKER>> workers;
+			for (unsigned worker = 0; worker < numWorkers; worker++) {
+				workers.emplace_back(new CAT_WORKER(module));
+			}
+			// Rewrites the IR, so it is done before any function is analyzed
+			if (UseSimplification) {
+				for (auto& task : tasks) {
+					has_modified_code |= workers[0]->state.presimplify(task->F);
+				}
+			}
+			// Declaring a CAT API function would change the classification workers read
+			SmallVector<Function*, 2> declared;
+			for (auto op : { CAT_API::GET, CAT_API::SET }) {
+				if (M.getFunction(CAT_API::API[op]) != nullptr) { continue; }
+				if (auto f = dyn_cast<Function>(module.declare(op, M.getContext()).getCallee())) {
+					declared.push_back(f);
+				}
+			}
+
+			WORK_QUEUES queues(numWorkers, sizes);
+			std::mutex commit;
+			std::condition_variable committed;
+			// The next function to commit, in the order of the module
+			auto next{ 0 };
+			auto work{ [&](unsigned worker) {
+				auto index{ 0 };
+				auto& DT{ workers[worker]->DT };
+				auto& state{ workers[worker]->state };
+				while (queues.pop(worker, index)) {
+					auto& task{ *tasks[index] };
+					auto& F{ task.F };
+					DT.recalculate(F);
+					AssumptionCache scanned(F);
+					auto& AC{ task.AC ? *task.AC : scanned };
+					BasicAAResult BAA(M.getDataLayout(), F, task.TLI, AC, &DT);
+					AAResults AA(task.TLI);
+					AA.addAAResult(BAA);
+					if (!UseSCCP) {
+						state.analyze(F, DT, AA);
+					}
+					std::unique_ptr<LoopInfo> LI;
+					if (UseInductionVariables || UseHoisting) {
+						LI.reset(new LoopInfo(DT));
+					}
+
+					// Rewriting creates constants and value handles in the shared context
+					std::unique_lock<std::mutex> lock(commit);
+					committed.wait(lock, [&] { return next == index; });
+					if (UseSCCP) {
+						state.analyze(F, DT, AA);
+					}
+					std::unique_ptr<ScalarEvolution> SE;
+					if (UseInductionVariables) {
+						SE.reset(new ScalarEvolution(F, task.TLI, AC, DT, *LI));
+					}
+					has_modified_code |= state.transform(F, DT, LI.get(), SE.get());
+					// The scalar evolution of the function holds value handles too
+					SE.reset();
+					tasks[index].reset();
+					next++;
+					committed.notify_all();
+				}
+			} };
+			std::vector<std::thread> threads;
+			for (unsigned worker = 1; worker < numWorkers; worker++) {
+				threads.emplace_back(work, worker);
+			}
+			work(0);
+			for (auto& thread : threads) {
+				thread.join();
+			}
+
+			for (auto f : declared) {
+				if (f->use_empty()) { f->eraseFromParent(); }
+			}
+			return has_modified_code;
+		}
+
+	private:
+		// The CAT API of the current module
+		CAT_MODULE module;
+
+	public:
+		void getAnalysisUsage(AnalysisUsage& AU) const override {
+			AU.setPreservesCFG();
+		}
+	};
+
+	/// <summary>
+	/// The CAT pass for the new pass manager. It runs over a module rather than a function, since
+	/// the CAT API is classified once per module, and asks the function analysis manager for the
+	/// analyses of each function, so cached ones are reused. No transformation changes the CFG,
+	/// so the analyses of the CFG are preserved even in the functions it rewrites.
+	/// </summary>
+	struct CAT_PASS : public PassInfoMixin<CAT_PASS> {
+		PreservedAnalyses run(Module& M, ModuleAnalysisManager& MAM) {
+			CAT_MODULE module;
+			module.initialize(M);
+			CAT_FUNCTION state(module);
+			auto& FAM{ MAM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager() };
+			PreservedAnalyses rewritten;
+			rewritten.preserveSet<CFGAnalyses>();
+			// Used to keep track of whether our pass has modified anything
+			bool has_modified_code{ false };
+			for (auto& F : M) {
+				if (F.isDeclaration()) { continue; }
+				// Skip functions that never call the CAT API before asking for any analysis
+				if (!module.cat_functions.count(&F)) {
+					NumFunctionsSkipped++;
+					continue;
+				}
+				if (UseSimplification && state.presimplify(F)) {
+					FAM.invalidate(F, rewritten);
+					has_modified_code = true;
+				}
+				auto& DT{ FAM.getResult<DominatorTreeAnalysis>(F) };
+				auto& AA{ FAM.getResult<AAManager>(F) };
+				state.analyze(F, DT, AA);
+				auto LI{ UseInductionVariables || UseHoisting ? &FAM.getResult<LoopAnalysis>(F) : nullptr };
+				auto SE{ UseInductionVariables ? &FAM.getResult<ScalarEvolutionAnalysis>(F) : nullptr };
+				if (state.transform(F, DT, LI, SE)) {
+					FAM.invalidate(F, rewritten);
+					has_modified_code = true;
+				}
+			}
+			if (!has_modified_code) {
+				return PreservedAnalyses::all();
+			}
+			// The analyses of the functions rewritten have already been invalidated
+			PreservedAnalyses PA;
+			PA.preserveSet<AllAnalysesOn<Function>>();
+			PA.preserve<FunctionAnalysisManagerModuleProxy>();
+			return PA;
+		}
+	};
+
+	/// <summary>
+	/// This pass prints, for the CAT variables read by every CAT API call, the definitions
+	/// reaching the call and their value, as answered by <c>CATReachingDefsAnalysis</c>.
+	/// </summary>
+	struct CAT_REACHING_DEFS_PRINTER : public PassInfoMixin<CAT_REACHING_DEFS_PRINTER> {
+		PreservedAnalyses run(Function& F, FunctionAnalysisManager& FAM) {
+			auto& RD{ FAM.getResult<CATReachingDefsAnalysis>(F) };
+			errs() << "CAT reaching definitions for function: " << F.getName() << "\n";
+			SmallVector<Instruction*, 4> defs;
+			for (auto& B : F) {
+				for (auto& I : B) {
+					auto callInst{ dyn_cast<CallInst>(&I) };
+					if (callInst == nullptr || callInst->getCalledFunction() == nullptr) { continue; }
+					if (!callInst->getCalledFunction()->getName().startswith("CAT_")) { continue; }
+					errs() << I << "\n";
+					for (auto j = 0; j < callInst->getNumArgOperands(); j++) {
+						auto V{ callInst->getArgOperand(j) };
+						if (!V->getType()->isPointerTy()) { continue; }
+						defs.clear();
+						RD.getReachingDefinitions(V, &I, defs);
+						errs() << "  " << j << ":";
+						for (auto def : defs) {
+							errs() << " [" << *def << " ]";
+						}
+						if (auto C = RD.getConstant(V, &I)) {
+							errs() << " = " << C->getSExtValue();
+						}
+						errs() << "\n";
+					}
+				}
+			}
+			return PreservedAnalyses::all();
+		}
+	};
+}
+
+namespace cat {
+	/// <summary>The reaching definitions of a function, and the CAT API of its module they were found with.</summary>
+	struct CATReachingDefsAnalysis::Result::STATE {
+		STATE() : function(module) {}
+
+		CAT_MODULE module;
+		CAT_FUNCTION function;
 	};
+
+	AnalysisKey CATReachingDefsAnalysis::Key;
+
+	CATReachingDefsAnalysis::Result::Result(Function& F, DominatorTree& DT, AAResults& AA) : state(new STATE()) {
+		state->module.initialize(*F.getParent(), false);
+		state->function.analyzeReachingDefinitions(F, DT, AA);
+	}
+
+	CATReachingDefsAnalysis::Result::Result(Result&& other) = default;
+
+	CATReachingDefsAnalysis::Result::~Result() = default;
+
+	void CATReachingDefsAnalysis::Result::getReachingDefinitions(const Value* handle, const Instruction* point,
+		SmallVectorImpl<Instruction*>& defs) const {
+		SmallVector<int, 4> indices;
+		state->function.reachingDefinitions(handle, point, indices);
+		for (auto def : indices) {
+			defs.push_back(state->function.getDefinition(def));
+		}
+	}
+
+	ConstantInt* CATReachingDefsAnalysis::Result::getConstant(const Value* handle, const Instruction* point) const {
+		auto value{ state->function.valueAt(handle, point) };
+		return value.isConstant() ? value.getConstant() : nullptr;
+	}
+
+	bool CATReachingDefsAnalysis::Result::invalidate(Function& F, const PreservedAnalyses& PA,
+		FunctionAnalysisManager::Invalidator& Inv) {
+		// The result points at the calls of the function, so preserving the CFG alone does not preserve it
+		auto PAC{ PA.getChecker<CATReachingDefsAnalysis>() };
+		return !(PAC.preserved() || PAC.preservedSet<AllAnalysesOn<Function>>()) ||
+			Inv.invalidate<DominatorTreeAnalysis>(F, PA) || Inv.invalidate<AAManager>(F, PA);
+	}
+
+	CATReachingDefsAnalysis::Result CATReachingDefsAnalysis::run(Function& F, FunctionAnalysisManager& FAM) {
+		return Result(F, FAM.getResult<DominatorTreeAnalysis>(F), FAM.getResult<AAManager>(F));
+	}
 }
 
 // Register this pass to `opt`
+char CAT_ANALYSES::ID = 0;
+static RegisterPass<CAT_ANALYSES> W("CAT-analyses", "The analyses of a function the CAT pass needs", true, true);
 char CAT::ID = 0;
 static RegisterPass<CAT> X("CAT", "Homework for the CAT class");
+char CAT_PARALLEL::ID = 0;
+static RegisterPass<CAT_PARALLEL> Y("CAT-parallel", "Homework for the CAT class, analyzing functions in parallel");
 
 // Register this pass to `clang`
-static CAT* _PassMaker = NULL;
+// Each pipeline gets its own instance, and only one of the two extension points adds it
 static RegisterStandardPasses _RegPass1(PassManagerBuilder::EP_OptimizerLast,
-	[](const PassManagerBuilder&, legacy::PassManagerBase& PM) {
-		if (!_PassMaker) { PM.add(_PassMaker = new CAT()); }
+	[](const PassManagerBuilder& Builder, legacy::PassManagerBase& PM) {
+		if (Builder.OptLevel > 0) { PM.add(new CAT()); }
 	});                                                  // ** for -Ox
 static RegisterStandardPasses _RegPass2(PassManagerBuilder::EP_EnabledOnOptLevel0,
-	[](const PassManagerBuilder&, legacy::PassManagerBase& PM) {
-		if (!_PassMaker) { PM.add(_PassMaker = new CAT()); }
+	[](const PassManagerBuilder& Builder, legacy::PassManagerBase& PM) {
+		if (Builder.OptLevel == 0) { PM.add(new CAT()); }
 	});                                                   // ** for -O0
+
+// Register this pass to the new pass manager, for `opt -load-pass-plugin -passes=CAT` and `clang -fpass-plugin`
+extern "C" LLVM_ATTRIBUTE_WEAK PassPluginLibraryInfo llvmGetPassPluginInfo() {
+	return { LLVM_PLUGIN_API_VERSION, "CAT", LLVM_VERSION_STRING, [](PassBuilder& PB) {
+		PB.registerAnalysisRegistrationCallback([](FunctionAnalysisManager& FAM) {
+			FAM.registerPass([] { return CATReachingDefsAnalysis(); });
+		});
+		PB.registerPipelineParsingCallback(
+			[](StringRef name, FunctionPassManager& FPM, ArrayRef<PassBuilder::PipelineElement>) {
+				if (name != "print<cat-reaching-defs>") { return false; }
+				FPM.addPass(CAT_REACHING_DEFS_PRINTER());
+				return true;
+			});
+		PB.registerPipelineParsingCallback(
+			[](StringRef name, ModulePassManager& MPM, ArrayRef<PassBuilder::PipelineElement>) {
+				if (name != "CAT") { return false; }
+				MPM.addPass(CAT_PASS());
+				return true;
+			});
+		PB.registerOptimizerLastEPCallback(
+			[](ModulePassManager& MPM, auto /* OptimizationLevel */) {
+				MPM.addPass(CAT_PASS());
+			});
+	} };
+}
@@ -0,0 +1,68 @@
+/// CatPass.h
+///
+/// The reaching definitions of "CAT" variables, as an analysis other passes can ask for.
+///
+/// Michael Huyler
+
+#ifndef CAT_PASS_H
+#define CAT_PASS_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/PassManager.h"
+
+#include <memory>
+
+namespace llvm {
+	class AAResults;
+	class ConstantInt;
+	class DominatorTree;
+	class Function;
+	class Instruction;
+	class Value;
+}
+
+namespace cat {
+	/// <summary>
+	/// Finds which definitions of each CAT variable of a function reach each program point, and the
+	/// constant value of the CAT variable there if it has one. The result is cached by the function
+	/// analysis manager until a pass does not preserve it, or the dominator tree or the alias
+	/// analysis it was computed with is invalidated.
+	/// </summary>
+	class CATReachingDefsAnalysis : public llvm::AnalysisInfoMixin<CATReachingDefsAnalysis> {
+	public:
+		class Result {
+		public:
+			Result(llvm::Function& F, llvm::DominatorTree& DT, llvm::AAResults& AA);
+			Result(Result&& other);
+			~Result();
+
+			/// <summary>Collects the definitions of a CAT variable reaching a program point.</summary>
+			/// <param name='handle'>The CAT variable.</param>
+			/// <param name='point'>The program point, whose own definitions do not reach it.</param>
+			/// <param name='defs'>Where to add the definitions, in the order of the function; none if the point is unreachable.</param>
+			void getReachingDefinitions(const llvm::Value* handle, const llvm::Instruction* point,
+				llvm::SmallVectorImpl<llvm::Instruction*>& defs) const;
+
+			/// <summary>Gets the value of a CAT variable at a program point.</summary>
+			/// <param name='handle'>The CAT variable.</param>
+			/// <param name='point'>The program point.</param>
+			/// <returns>The value every definition reaching the point sets the CAT variable to, or <c>nullptr</c> if there is none.</returns>
+			llvm::ConstantInt* getConstant(const llvm::Value* handle, const llvm::Instruction* point) const;
+
+			bool invalidate(llvm::Function& F, const llvm::PreservedAnalyses& PA,
+				llvm::FunctionAnalysisManager::Invalidator& Inv);
+
+		private:
+			struct STATE;
+			std::unique_ptr<STATE> state;
+		};
+
+		Result run(llvm::Function& F, llvm::FunctionAnalysisManager& FAM);
+
+	private:
+		friend llvm::AnalysisInfoMixin<CATReachingDefsAnalysis>;
+		static llvm::AnalysisKey Key;
+	};
+}
+
+#endif
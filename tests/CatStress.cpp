@@ -0,0 +1,140 @@
+/// CatStress.cpp
+///
+/// Runs the CAT pass on many threads at once, each thread with its own LLVMContext, and checks every thread
+/// prints the same modules as a serial run, of the same pass or of the reference pass.
+///
+/// Usage: cat_stress -load CAT.so [-stress-pass=CAT] [-stress-reference=CAT] [-stress-threads=N] [-stress-runs=N]
+///        [CAT options] files...
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Pass.h"
+#include "llvm/PassInfo.h"
+#include "llvm/PassRegistry.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Passes/PassPlugin.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/PluginLoader.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+
+static cl::list<std::string> Inputs(cl::Positional, cl::OneOrMore, cl::desc("<input files>"));
+static cl::opt<std::string> PassName("stress-pass", cl::init("CAT"), cl::desc("The legacy pass to run"));
+static cl::opt<std::string> ReferenceName("stress-reference", cl::init(""),
+	cl::desc("The legacy pass of the serial run every thread must match, by default the pass run"));
+static cl::opt<unsigned> NumThreads("stress-threads", cl::init(8), cl::desc("The number of threads running the pass"));
+static cl::opt<unsigned> NumRuns("stress-runs", cl::init(10), cl::desc("The number of times each thread runs the pass on every input"));
+
+namespace {
+	/// <summary>
+	/// Runs the pass on the inputs within one LLVMContext, once with the legacy pass manager and once with the new
+	/// one, printing the modules.
+	/// </summary>
+	struct CAT_RUNNER {
+		const PassInfo& info;
+		std::vector<PassPlugin>& plugins;
+
+		/// <summary>Runs the pass on every input.</summary>
+		/// <param name='outputs'>Where to print the modules, two per input; the legacy one first.</param>
+		/// <returns>Whether every input could be read.</returns>
+		bool run(std::vector<std::string>& outputs) {
+			LLVMContext context;
+			outputs.clear();
+
+			for (auto& file : Inputs) {
+				for (auto legacy : { true, false }) {
+					SMDiagnostic error;
+					auto M{ parseIRFile(file, error, context) };
+					if (!M) {
+						error.print("cat_stress", errs());
+						return false;
+					}
+
+					if (legacy) {
+						legacy::PassManager PM;
+						PM.add(info.createPass());
+						PM.run(*M);
+					}
+					else {
+						PassBuilder PB;
+						for (auto& plugin : plugins) { plugin.registerPassBuilderCallbacks(PB); }
+
+						LoopAnalysisManager LAM;
+						FunctionAnalysisManager FAM;
+						CGSCCAnalysisManager CGAM;
+						ModuleAnalysisManager MAM;
+						PB.registerModuleAnalyses(MAM);
+						PB.registerCGSCCAnalyses(CGAM);
+						PB.registerFunctionAnalyses(FAM);
+						PB.registerLoopAnalyses(LAM);
+						PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+						ModulePassManager MPM;
+						if (auto err = PB.parsePassPipeline(MPM, "CAT")) {
+							errs() << "cat_stress: " << toString(std::move(err)) << "\n";
+							return false;
+						}
+						MPM.run(*M, MAM);
+					}
+
+					outputs.emplace_back();
+					raw_string_ostream out(outputs.back());
+					M->print(out, nullptr);
+				}
+			}
+			return true;
+		}
+	};
+}
+
+int main(int argc, char** argv) {
+	cl::ParseCommandLineOptions(argc, argv, "CAT pass stress test\n");
+
+	auto info{ PassRegistry::getPassRegistry()->getPassInfo(PassName) };
+	auto referenceInfo{ ReferenceName.empty() ? info : PassRegistry::getPassRegistry()->getPassInfo(ReferenceName) };
+	if (!info || !referenceInfo) {
+		errs() << "cat_stress: the pass " << (info ? ReferenceName : PassName) << " is not registered; load it with -load\n";
+		return 1;
+	}
+
+	std::vector<PassPlugin> plugins;
+	for (auto i{ 0u }; i < PluginLoader::getNumPlugins(); ++i) {
+		auto plugin{ PassPlugin::Load(PluginLoader::getPlugin(i)) };
+		if (!plugin) {
+			errs() << "cat_stress: " << toString(plugin.takeError()) << "\n";
+			return 1;
+		}
+		plugins.push_back(*plugin);
+	}
+
+	// The serial run every thread must match
+	CAT_RUNNER referenceRunner{ *referenceInfo, plugins };
+	std::vector<std::string> reference;
+	if (!referenceRunner.run(reference)) { return 1; }
+
+	CAT_RUNNER runner{ *info, plugins };
+	std::atomic<unsigned> mismatches{ 0 };
+	std::vector<std::thread> threads;
+	for (auto t{ 0u }; t < NumThreads; ++t) {
+		threads.emplace_back([&, t] {
+			std::vector<std::string> outputs;
+			for (auto r{ 0u }; r < NumRuns; ++r) {
+				if (runner.run(outputs) && outputs == reference) { continue; }
+				errs() << "cat_stress: thread " << t << " run " << r << " differs from the serial run\n";
+				++mismatches;
+			}
+		});
+	}
+	for (auto& thread : threads) { thread.join(); }
+
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,55 @@
+; A CAT_set followed by another definition of its CAT variable, with no CAT_get
+; in between, is dead only if nothing else can read the CAT variable: neither a
+; function it is passed to nor one reading it through a global.
+
+declare i8* @CAT_new(i64)
+declare i64 @CAT_get(i8*)
+declare void @CAT_set(i8*, i64)
+declare void @CAT_add(i8*, i8*, i8*)
+declare void @show(i8*)
+declare void @show_global()
+declare void @print(i64)
+
+@G = external global i8*
+
+; The first definitions of %x and %y are read by @show and @show_global, those of %z by nobody
+; DCE-LABEL: define void @f(
+; DCE: call void @CAT_set(i8* %x, i64 5)
+; DCE-NEXT: call void @show(i8* %x)
+; DCE-NEXT: call void @CAT_set(i8* %x, i64 6)
+; DCE: call void @CAT_set(i8* %y, i64 7)
+; DCE-NEXT: call void @show_global()
+; DCE-NEXT: call void @CAT_set(i8* %y, i64 8)
+; DCE-NOT: %z
+; DCE: ret void
+define void @f() {
+entry:
+  %x = call i8* @CAT_new(i64 0)
+  call void @CAT_set(i8* %x, i64 5)
+  call void @show(i8* %x)
+  call void @CAT_set(i8* %x, i64 6)
+  %a = call i64 @CAT_get(i8* %x)
+  call void @print(i64 %a)
+
+  %y = call i8* @CAT_new(i64 0)
+  store i8* %y, i8** @G
+  call void @CAT_set(i8* %y, i64 7)
+  call void @show_global()
+  call void @CAT_set(i8* %y, i64 8)
+  %b = call i64 @CAT_get(i8* %y)
+  call void @print(i64 %b)
+
+  %z = call i8* @CAT_new(i64 0)
+  call void @CAT_set(i8* %z, i64 1)
+  call void @CAT_add(i8* %z, i8* %z, i8* %z)
+  call void @CAT_set(i8* %z, i64 2)
+  %c = call i64 @CAT_get(i8* %z)
+  call void @print(i64 %c)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  call void @f()
+  ret i32 0
+}
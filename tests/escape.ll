@@ -0,0 +1,33 @@
+; A CAT variable escapes through a store laid out after a call reading it in a
+; loop. The call (re)defines it from the second iteration on, so CAT_get must
+; not be folded to its initial value.
+
+declare i8* @CAT_new(i64)
+declare i64 @CAT_get(i8*)
+declare void @touch()
+declare void @print(i64)
+@G = external global i8*
+
+define i64 @f() {
+entry:
+  %x = call i8* @CAT_new(i64 1)
+  br label %loop
+loop:
+  %k = phi i64 [ 0, %entry ], [ %k1, %loop ]
+  %s = phi i64 [ 0, %entry ], [ %s1, %loop ]
+  call void @touch()
+  %g = call i64 @CAT_get(i8* %x)
+  %s1 = add i64 %s, %g
+  store i8* %x, i8** @G
+  %k1 = add i64 %k, 1
+  %c = icmp slt i64 %k1, 3
+  br i1 %c, label %loop, label %exit
+exit:
+  ret i64 %s1
+}
+
+define i32 @main() {
+  %r = call i64 @f()
+  call void @print(i64 %r)
+  ret i32 0
+}
@@ -0,0 +1,95 @@
+; CAT variables whose values are known, so the CAT pass folds their CAT_get
+; calls to constants, in straight-line code, across branches and in loops.
+; A CAT_set through a handle merged by a PHI may (re)define either CAT
+; variable, which must not be folded to its value before.
+
+declare i8* @CAT_new(i64)
+declare i64 @CAT_get(i8*)
+declare void @CAT_set(i8*, i64)
+declare void @CAT_add(i8*, i8*, i8*)
+declare void @CAT_sub(i8*, i8*, i8*)
+declare void @print(i64)
+
+define i64 @straight() {
+entry:
+  %x = call i8* @CAT_new(i64 5)
+  %y = call i8* @CAT_new(i64 8)
+  %z = call i8* @CAT_new(i64 0)
+  call void @CAT_add(i8* %z, i8* %x, i8* %y)
+  call void @CAT_sub(i8* %x, i8* %z, i8* %x)
+  %a = call i64 @CAT_get(i8* %z)
+  %b = call i64 @CAT_get(i8* %x)
+  %r = add i64 %a, %b
+  ret i64 %r
+}
+
+define i64 @diamond(i1 %c) {
+entry:
+  %x = call i8* @CAT_new(i64 1)
+  br i1 %c, label %then, label %else
+then:
+  call void @CAT_set(i8* %x, i64 7)
+  br label %join
+else:
+  call void @CAT_set(i8* %x, i64 7)
+  br label %join
+join:
+  %g = call i64 @CAT_get(i8* %x)
+  ret i64 %g
+}
+
+define i64 @loop(i64 %n) {
+entry:
+  %x = call i8* @CAT_new(i64 3)
+  %y = call i8* @CAT_new(i64 4)
+  %s = call i8* @CAT_new(i64 0)
+  br label %head
+head:
+  %k = phi i64 [ 0, %entry ], [ %k1, %body ]
+  %c = icmp slt i64 %k, %n
+  br i1 %c, label %body, label %exit
+body:
+  call void @CAT_add(i8* %s, i8* %x, i8* %y)
+  %g = call i64 @CAT_get(i8* %x)
+  %k1 = add i64 %k, %g
+  br label %head
+exit:
+  %r = call i64 @CAT_get(i8* %s)
+  ret i64 %r
+}
+
+define i64 @merged(i1 %c) {
+entry:
+  %x0 = call i8* @CAT_new(i64 3)
+  %x1 = call i8* @CAT_new(i64 3)
+  %y = call i8* @CAT_new(i64 6)
+  br i1 %c, label %then, label %else
+then:
+  br label %join
+else:
+  br label %join
+join:
+  %h = phi i8* [ %x0, %then ], [ %x1, %else ]
+  %v = call i64 @CAT_get(i8* %y)
+  call void @CAT_set(i8* %h, i64 %v)
+  %g = call i64 @CAT_get(i8* %x0)
+  ret i64 %g
+}
+
+define i32 @main() {
+  %a = call i64 @straight()
+  call void @print(i64 %a)
+  %b = call i64 @diamond(i1 true)
+  call void @print(i64 %b)
+  %c = call i64 @diamond(i1 false)
+  call void @print(i64 %c)
+  %d = call i64 @loop(i64 10)
+  call void @print(i64 %d)
+  %e = call i64 @loop(i64 0)
+  call void @print(i64 %e)
+  %f = call i64 @merged(i1 true)
+  call void @print(i64 %f)
+  %g = call i64 @merged(i1 false)
+  call void @print(i64 %g)
+  ret i32 0
+}
@@ -0,0 +1,38 @@
+; A CAT variable (re)defined between two of its CAT_get calls through a pointer
+; PHI merging it with another handle. The second CAT_get reads a new value, so
+; it must not reuse the result of the first one.
+
+declare i8* @CAT_new(i64)
+declare void @CAT_add(i8*, i8*, i8*)
+declare i64 @CAT_get(i8*)
+declare void @opaque(i8*)
+declare void @print(i64)
+
+define void @f(i64 %n) {
+entry:
+  %x = call i8* @CAT_new(i64 %n)
+  %y = call i8* @CAT_new(i64 1)
+  %c = icmp sgt i64 %n, 5
+  br i1 %c, label %big, label %small
+big:
+  br label %join
+small:
+  br label %join
+join:
+  %h = phi i8* [ %x, %big ], [ %y, %small ]
+  %g1 = call i64 @CAT_get(i8* %x)
+  call void @print(i64 %g1)
+  call void @CAT_add(i8* %h, i8* %h, i8* %h)
+  %g2 = call i64 @CAT_get(i8* %x)
+  call void @print(i64 %g2)
+  call void @opaque(i8* %h)
+  %g3 = call i64 @CAT_get(i8* %x)
+  call void @print(i64 %g3)
+  ret void
+}
+
+define i32 @main() {
+  call void @f(i64 3)
+  call void @f(i64 7)
+  ret i32 0
+}
@@ -0,0 +1,66 @@
+; A CAT variable incremented in an inner loop nested in a loop with a constant
+; trip count. The increment runs once per inner iteration, not once per outer
+; iteration, so it is no induction variable of the outer loop.
+
+declare i8* @CAT_new(i64)
+declare void @CAT_add(i8*, i8*, i8*)
+declare i64 @CAT_get(i8*)
+declare void @print(i64)
+
+; The inner loop runs %n times, or once if %n is 0
+define i64 @unknown(i64 %n) {
+entry:
+  %i = call i8* @CAT_new(i64 0)
+  %one = call i8* @CAT_new(i64 1)
+  br label %outer
+outer:
+  %k = phi i64 [ 0, %entry ], [ %k1, %latch ]
+  br label %inner
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j1, %inner ]
+  call void @CAT_add(i8* %i, i8* %i, i8* %one)
+  %j1 = add i64 %j, 1
+  %c = icmp slt i64 %j1, %n
+  br i1 %c, label %inner, label %latch
+latch:
+  %k1 = add i64 %k, 1
+  %c2 = icmp slt i64 %k1, 10
+  br i1 %c2, label %outer, label %exit
+exit:
+  %r = call i64 @CAT_get(i8* %i)
+  ret i64 %r
+}
+
+; The inner loop runs 3 times, so the increment is an induction variable of it
+define i64 @constant() {
+entry:
+  %i = call i8* @CAT_new(i64 0)
+  %two = call i8* @CAT_new(i64 2)
+  br label %outer
+outer:
+  %k = phi i64 [ 0, %entry ], [ %k1, %latch ]
+  br label %inner
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j1, %inner ]
+  call void @CAT_add(i8* %i, i8* %i, i8* %two)
+  %j1 = add i64 %j, 1
+  %c = icmp slt i64 %j1, 3
+  br i1 %c, label %inner, label %latch
+latch:
+  %k1 = add i64 %k, 1
+  %c2 = icmp slt i64 %k1, 10
+  br i1 %c2, label %outer, label %exit
+exit:
+  %r = call i64 @CAT_get(i8* %i)
+  ret i64 %r
+}
+
+define i32 @main() {
+  %a = call i64 @unknown(i64 0)
+  call void @print(i64 %a)
+  %b = call i64 @unknown(i64 3)
+  call void @print(i64 %b)
+  %c = call i64 @constant()
+  call void @print(i64 %c)
+  ret i32 0
+}
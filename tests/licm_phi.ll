@@ -0,0 +1,56 @@
+; CAT variables (re)defined in a loop through a pointer PHI merging them with
+; another handle. CAT_get of the handle they are merged with reads a new value
+; on every iteration, so it must not be hoisted out of the loop.
+
+declare i8* @CAT_new(i64)
+declare void @CAT_sub(i8*, i8*, i8*)
+declare i64 @CAT_get(i8*)
+declare void @opaque(i8*)
+declare void @print(i64)
+
+; Through a CAT_sub of the PHI
+define i64 @sub(i64 %n) {
+entry:
+  %x = call i8* @CAT_new(i64 %n)
+  %one = call i8* @CAT_new(i64 1)
+  br label %loop
+loop:
+  %k = phi i64 [ 0, %entry ], [ %k1, %loop ]
+  %s = phi i64 [ 0, %entry ], [ %s1, %loop ]
+  %h = phi i8* [ %x, %entry ], [ %h, %loop ]
+  %g = call i64 @CAT_get(i8* %x)
+  %s1 = add i64 %s, %g
+  call void @CAT_sub(i8* %h, i8* %h, i8* %one)
+  %k1 = add i64 %k, 1
+  %c = icmp slt i64 %k1, 3
+  br i1 %c, label %loop, label %exit
+exit:
+  ret i64 %s1
+}
+
+; Through a call passed the PHI
+define i64 @call(i64 %n) {
+entry:
+  %x = call i8* @CAT_new(i64 %n)
+  br label %loop
+loop:
+  %k = phi i64 [ 0, %entry ], [ %k1, %loop ]
+  %s = phi i64 [ 0, %entry ], [ %s1, %loop ]
+  %h = phi i8* [ %x, %entry ], [ %h, %loop ]
+  %g = call i64 @CAT_get(i8* %x)
+  %s1 = add i64 %s, %g
+  call void @opaque(i8* %h)
+  %k1 = add i64 %k, 1
+  %c = icmp slt i64 %k1, 3
+  br i1 %c, label %loop, label %exit
+exit:
+  ret i64 %s1
+}
+
+define i32 @main() {
+  %a = call i64 @sub(i64 10)
+  call void @print(i64 %a)
+  %b = call i64 @call(i64 10)
+  call void @print(i64 %b)
+  ret i32 0
+}
@@ -0,0 +1,67 @@
+; -CAT-parallel must give the same module as -CAT. The target library info the
+; CAT pass analyzes calls with is built for no target, where memalign is not a
+; known allocation function, so the call may modify the CAT variable of @G.
+
+target triple = "x86_64-pc-linux-gnu"
+
+declare i8* @CAT_new(i64)
+declare i64 @CAT_get(i8*)
+declare void @CAT_set(i8*, i64)
+declare void @CAT_add(i8*, i8*, i8*)
+declare noalias i8* @memalign(i64, i64)
+declare void @print(i64)
+
+@G = external global i8*
+
+; PARALLEL-LABEL: define i64 @aligned(
+; PARALLEL: %v = call i64 @CAT_get(i8* %x)
+; PARALLEL-NEXT: ret i64 %v
+define i64 @aligned() {
+entry:
+  %x = call i8* @CAT_new(i64 5)
+  store i8* %x, i8** @G
+  %m = call i8* @memalign(i64 16, i64 32)
+  %v = call i64 @CAT_get(i8* %x)
+  ret i64 %v
+}
+
+define i64 @sum(i64 %n) {
+entry:
+  %s = call i8* @CAT_new(i64 0)
+  %one = call i8* @CAT_new(i64 1)
+  br label %loop
+loop:
+  %i = phi i64 [ 0, %entry ], [ %next, %loop ]
+  call void @CAT_add(i8* %s, i8* %s, i8* %one)
+  %next = add i64 %i, 1
+  %done = icmp eq i64 %next, %n
+  br i1 %done, label %exit, label %loop
+exit:
+  %v = call i64 @CAT_get(i8* %s)
+  ret i64 %v
+}
+
+; PARALLEL-LABEL: define i64 @choose(
+; PARALLEL: ret i64 2
+define i64 @choose(i1 %c) {
+entry:
+  %x = call i8* @CAT_new(i64 2)
+  br i1 %c, label %then, label %join
+then:
+  call void @CAT_set(i8* %x, i64 2)
+  br label %join
+join:
+  %v = call i64 @CAT_get(i8* %x)
+  ret i64 %v
+}
+
+define i32 @main() {
+entry:
+  %a = call i64 @aligned()
+  call void @print(i64 %a)
+  %b = call i64 @sum(i64 4)
+  call void @print(i64 %b)
+  %c = call i64 @choose(i1 true)
+  call void @print(i64 %c)
+  ret i32 0
+}
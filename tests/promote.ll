@@ -0,0 +1,66 @@
+; CAT variables that never escape their function are promoted to SSA values,
+; across a loop and a diamond. A CAT variable passed to another function
+; escapes, and must keep its CAT API calls.
+
+declare i8* @CAT_new(i64)
+declare i64 @CAT_get(i8*)
+declare void @CAT_set(i8*, i64)
+declare void @CAT_add(i8*, i8*, i8*)
+declare void @CAT_sub(i8*, i8*, i8*)
+declare void @opaque(i8*)
+declare void @print(i64)
+
+; %i, %s and %one are gone, %e is only read and written through the CAT API
+; PROMOTE-LABEL: define i64 @f(
+; PROMOTE-NOT: alloca
+; PROMOTE: entry:
+; PROMOTE-NEXT: %e = call i8* @CAT_new(i64 5)
+; PROMOTE-NEXT: br label %head
+; PROMOTE-NOT: i8* %{{(i|s|one)}}{{[,)]}}
+; PROMOTE: call void @CAT_set(i8* %e,
+; PROMOTE-NOT: i8* %{{(i|s|one)}}{{[,)]}}
+; PROMOTE: call void @opaque(i8* %e)
+; PROMOTE-NOT: i8* %{{(i|s|one)}}{{[,)]}}
+; PROMOTE: ret i64
+define i64 @f(i64 %n, i1 %c) {
+entry:
+  %i = call i8* @CAT_new(i64 0)
+  %s = call i8* @CAT_new(i64 0)
+  %one = call i8* @CAT_new(i64 1)
+  %e = call i8* @CAT_new(i64 5)
+  br label %head
+head:
+  %k = phi i64 [ 0, %entry ], [ %k1, %body ]
+  %cmp = icmp slt i64 %k, %n
+  br i1 %cmp, label %body, label %exit
+body:
+  call void @CAT_add(i8* %s, i8* %s, i8* %i)
+  call void @CAT_add(i8* %i, i8* %i, i8* %one)
+  call void @CAT_add(i8* %e, i8* %e, i8* %one)
+  %k1 = add i64 %k, 1
+  br label %head
+exit:
+  br i1 %c, label %then, label %else
+then:
+  call void @CAT_set(i8* %s, i64 100)
+  call void @opaque(i8* %e)
+  br label %join
+else:
+  call void @CAT_sub(i8* %s, i8* %s, i8* %e)
+  br label %join
+join:
+  %a = call i64 @CAT_get(i8* %s)
+  %b = call i64 @CAT_get(i8* %e)
+  %r = add i64 %a, %b
+  ret i64 %r
+}
+
+define i32 @main() {
+  %a = call i64 @f(i64 4, i1 true)
+  call void @print(i64 %a)
+  %b = call i64 @f(i64 4, i1 false)
+  call void @print(i64 %b)
+  %c = call i64 @f(i64 0, i1 false)
+  call void @print(i64 %c)
+  ret i32 0
+}
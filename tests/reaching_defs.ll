@@ -0,0 +1,43 @@
+; The reaching definitions of the CAT variables read by each CAT API call, and
+; their value when all of them agree, as printed by print<cat-reaching-defs>.
+; The result is computed once, and again only after a pass invalidates the
+; dominator tree or the alias analysis it was computed with.
+
+declare i8* @CAT_new(i64)
+declare i64 @CAT_get(i8*)
+declare void @CAT_set(i8*, i64)
+declare void @CAT_add(i8*, i8*, i8*)
+
+; PRINT-LABEL: CAT reaching definitions for function: f
+; PRINT: call void @CAT_add(i8* %y, i8* %x, i8* %y)
+; PRINT-NEXT: 0: [ %y = call i8* @CAT_new(i64 2) ] = 2
+; PRINT-NEXT: 1: [ %x = call i8* @CAT_new(i64 1) ] [ call void @CAT_set(i8* %x, i64 3) ]{{$}}
+; PRINT-NEXT: 2: [ %y = call i8* @CAT_new(i64 2) ] = 2
+; PRINT-NEXT: %v = call i64 @CAT_get(i8* %y)
+; PRINT-NEXT: 0: [ call void @CAT_add(i8* %y, i8* %x, i8* %y) ]{{$}}
+
+; INVALIDATE: Running pass: {{.*}}CAT_REACHING_DEFS_PRINTER on f
+; INVALIDATE-NEXT: Running analysis: cat::CATReachingDefsAnalysis on f
+; INVALIDATE: Running pass: {{.*}}CAT_REACHING_DEFS_PRINTER on f
+; INVALIDATE-NOT: Running analysis: cat::CATReachingDefsAnalysis
+; INVALIDATE: Running pass: InvalidateAnalysisPass<{{.*}}DominatorTreeAnalysis> on f
+; INVALIDATE: Invalidating analysis: cat::CATReachingDefsAnalysis on f
+; INVALIDATE: Running pass: {{.*}}CAT_REACHING_DEFS_PRINTER on f
+; INVALIDATE-NEXT: Running analysis: cat::CATReachingDefsAnalysis on f
+; INVALIDATE: Running pass: InvalidateAnalysisPass<{{.*}}AAManager> on f
+; INVALIDATE: Invalidating analysis: cat::CATReachingDefsAnalysis on f
+; INVALIDATE: Running pass: {{.*}}CAT_REACHING_DEFS_PRINTER on f
+; INVALIDATE-NEXT: Running analysis: cat::CATReachingDefsAnalysis on f
+define void @f(i1 %c) {
+entry:
+  %x = call i8* @CAT_new(i64 1)
+  %y = call i8* @CAT_new(i64 2)
+  br i1 %c, label %then, label %join
+then:
+  call void @CAT_set(i8* %x, i64 3)
+  br label %join
+join:
+  call void @CAT_add(i8* %y, i8* %x, i8* %y)
+  %v = call i64 @CAT_get(i8* %y)
+  ret void
+}
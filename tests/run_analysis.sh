@@ -0,0 +1,17 @@
+#!/bin/bash
+# Runs a pipeline of the new pass manager, with the CAT pass plugin loaded, on a test
+# program, and checks what opt prints against the lines of the test program with the
+# given prefix, as checked by FileCheck.
+#
+# Usage: run_analysis.sh <opt> <FileCheck> <CAT pass> <test.ll> <check prefix> <opt flags>...
+
+opt="$1"
+filecheck="$2"
+pass="$3"
+test="$4"
+prefix="$5"
+shift 5
+
+set -o pipefail
+"$opt" -load-pass-plugin "$pass" "$@" "$test" -disable-output 2>&1 |
+  "$filecheck" --check-prefix="$prefix" "$test" || exit 1
@@ -0,0 +1,40 @@
+#!/bin/bash
+# Runs a test program with and without the CAT pass, and fails if the outputs differ.
+# Given a check prefix, the optimized program must also match the lines of the test
+# program with that prefix, as checked by FileCheck; a prefix of - checks nothing.
+#
+# Usage: run_test.sh <opt> <llvm-link> <lli> <FileCheck> <CAT pass> <runtime.ll> <test.ll> <check prefix> <opt flags>...
+
+opt="$1"
+link="$2"
+lli="$3"
+filecheck="$4"
+pass="$5"
+runtime="$6"
+test="$7"
+prefix="$8"
+shift 8
+
+tmp=`mktemp -d`
+trap "rm -rf $tmp" EXIT
+
+# The CAT pass is a legacy pass; newer versions of opt default to the new pass manager
+legacy=""
+"$opt" --help-hidden 2>/dev/null | grep -q -- "-enable-new-pm" && legacy="-enable-new-pm=0"
+
+"$link" "$test" "$runtime" -o $tmp/expected.bc || exit 1
+"$lli" $tmp/expected.bc > $tmp/expected.txt || exit 1
+
+"$opt" $legacy -load "$pass" "$@" "$test" -o $tmp/optimized.bc || exit 1
+"$link" $tmp/optimized.bc "$runtime" -o $tmp/actual.bc || exit 1
+"$lli" $tmp/actual.bc > $tmp/actual.txt || exit 1
+
+if ! diff $tmp/expected.txt $tmp/actual.txt; then
+  echo "$test: the output with $* differs from the output without the CAT pass"
+  exit 1
+fi
+
+if [ "$prefix" != "-" ]; then
+  "$opt" $legacy -load "$pass" "$@" "$test" -S -o $tmp/optimized.ll || exit 1
+  "$filecheck" --check-prefix="$prefix" "$test" < $tmp/optimized.ll || exit 1
+fi
@@ -0,0 +1,88 @@
+; The CAT runtime the test programs are linked with, and functions reading and
+; writing CAT variables that the CAT pass cannot see into.
+
+declare i8* @malloc(i64)
+
+define i8* @CAT_new(i64 %v) {
+  %p = call i8* @malloc(i64 8)
+  %q = bitcast i8* %p to i64*
+  store i64 %v, i64* %q
+  ret i8* %p
+}
+
+define void @CAT_set(i8* %p, i64 %v) {
+  %q = bitcast i8* %p to i64*
+  store i64 %v, i64* %q
+  ret void
+}
+
+define i64 @CAT_get(i8* %p) {
+  %q = bitcast i8* %p to i64*
+  %v = load i64, i64* %q
+  ret i64 %v
+}
+
+define void @CAT_add(i8* %d, i8* %a, i8* %b) {
+  %x = call i64 @CAT_get(i8* %a)
+  %y = call i64 @CAT_get(i8* %b)
+  %s = add i64 %x, %y
+  call void @CAT_set(i8* %d, i64 %s)
+  ret void
+}
+
+define void @CAT_sub(i8* %d, i8* %a, i8* %b) {
+  %x = call i64 @CAT_get(i8* %a)
+  %y = call i64 @CAT_get(i8* %b)
+  %s = sub i64 %x, %y
+  call void @CAT_set(i8* %d, i64 %s)
+  ret void
+}
+
+; Adds 100 to a CAT variable
+define void @opaque(i8* %p) {
+  %x = call i64 @CAT_get(i8* %p)
+  %y = add i64 %x, 100
+  call void @CAT_set(i8* %p, i64 %y)
+  ret void
+}
+
+; Adds 7 to the CAT variable stored in @G, if any
+@G = global i8* null
+
+define void @touch() {
+  %p = load i8*, i8** @G
+  %z = icmp eq i8* %p, null
+  br i1 %z, label %done, label %modify
+modify:
+  %x = call i64 @CAT_get(i8* %p)
+  %y = add i64 %x, 7
+  call void @CAT_set(i8* %p, i64 %y)
+  br label %done
+done:
+  ret void
+}
+
+; Prints a CAT variable
+define void @show(i8* %p) {
+  %x = call i64 @CAT_get(i8* %p)
+  call void @print(i64 %x)
+  ret void
+}
+
+; Prints the CAT variable stored in @G
+define void @show_global() {
+  %p = load i8*, i8** @G
+  call void @show(i8* %p)
+  ret void
+}
+
+declare i32 @printf(i8*, ...)
+
+@format = private constant [5 x i8] c"%ld\0A\00"
+
+; Prints a value on its own line
+define void @print(i64 %v) {
+  %p = getelementptr [5 x i8], [5 x i8]* @format, i64 0, i64 0
+  call i32 (i8*, ...) @printf(i8* %p, i64 %v)
+  ret void
+}
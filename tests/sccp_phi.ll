@@ -0,0 +1,38 @@
+; A CAT_set through a handle merged by a PHI may (re)define either CAT variable.
+; SCCP must then merge an unknown value into the virtual PHI of the CAT variable
+; where the paths with and without the CAT_set join, rather than its value before.
+
+declare i8* @CAT_new(i64)
+declare i64 @CAT_get(i8*)
+declare void @CAT_set(i8*, i64)
+declare void @print(i64)
+
+define i64 @f(i1 %c, i1 %d) {
+entry:
+  %x0 = call i8* @CAT_new(i64 3)
+  %x1 = call i8* @CAT_new(i64 3)
+  br i1 %c, label %then, label %else
+then:
+  br label %join
+else:
+  br label %join
+join:
+  %h = phi i8* [ %x0, %then ], [ %x1, %else ]
+  br i1 %d, label %write, label %merge
+write:
+  call void @CAT_set(i8* %h, i64 6)
+  br label %merge
+merge:
+  %g = call i64 @CAT_get(i8* %x0)
+  ret i64 %g
+}
+
+define i32 @main() {
+  %a = call i64 @f(i1 true, i1 true)
+  call void @print(i64 %a)
+  %b = call i64 @f(i1 true, i1 false)
+  call void @print(i64 %b)
+  %c = call i64 @f(i1 false, i1 true)
+  call void @print(i64 %c)
+  ret i32 0
+}
@@ -0,0 +1,82 @@
+; Every identity of CAT_add and CAT_sub, on CAT variables whose values are not
+; known, with and without the destination being one of the operands. A copy to
+; another CAT variable is left as it is.
+
+declare i8* @CAT_new(i64)
+declare i64 @CAT_get(i8*)
+declare void @CAT_set(i8*, i64)
+declare void @CAT_add(i8*, i8*, i8*)
+declare void @CAT_sub(i8*, i8*, i8*)
+declare void @print(i64)
+
+; SIMPLIFY-LABEL: define void @f(
+; x = y - y, and y = y - y
+; SIMPLIFY: call void @CAT_set(i8* %a, i64 0)
+; SIMPLIFY: call void @CAT_set(i8* %y, i64 0)
+; x = x + 0, x = 0 + x and x = x - 0 are gone, x = y + 0 stays
+; SIMPLIFY-NOT: call void @CAT_{{add|sub}}(i8* %{{b|c|d}},
+; SIMPLIFY: call void @CAT_add(i8* %e, i8* %y2, i8* %zero)
+; SIMPLIFY-NOT: call void @CAT_{{add|sub}}(i8* %{{b|c|d}},
+; x = y + x becomes x = x + y
+; SIMPLIFY: call void @CAT_add(i8* %g, i8* %g, i8* %y3)
+; SIMPLIFY: ret void
+define void @f(i64 %n) {
+entry:
+  %zero = call i8* @CAT_new(i64 0)
+
+  ; SUB, SAME_OPERANDS: SET_ZERO
+  %a = call i8* @CAT_new(i64 0)
+  %y = call i8* @CAT_new(i64 0)
+  call void @CAT_set(i8* %y, i64 %n)
+  call void @CAT_sub(i8* %a, i8* %y, i8* %y)
+  %a0 = call i64 @CAT_get(i8* %a)
+  call void @print(i64 %a0)
+  call void @CAT_sub(i8* %y, i8* %y, i8* %y)
+  %y0 = call i64 @CAT_get(i8* %y)
+  call void @print(i64 %y0)
+
+  ; ADD, ZERO_2: COPY_1
+  %b = call i8* @CAT_new(i64 0)
+  call void @CAT_set(i8* %b, i64 %n)
+  call void @CAT_add(i8* %b, i8* %b, i8* %zero)
+  %b0 = call i64 @CAT_get(i8* %b)
+  call void @print(i64 %b0)
+
+  ; ADD, ZERO_1: COPY_2
+  %c = call i8* @CAT_new(i64 0)
+  call void @CAT_set(i8* %c, i64 %n)
+  call void @CAT_add(i8* %c, i8* %zero, i8* %c)
+  %c0 = call i64 @CAT_get(i8* %c)
+  call void @print(i64 %c0)
+
+  ; SUB, ZERO_2: COPY_1
+  %d = call i8* @CAT_new(i64 0)
+  call void @CAT_set(i8* %d, i64 %n)
+  call void @CAT_sub(i8* %d, i8* %d, i8* %zero)
+  %d0 = call i64 @CAT_get(i8* %d)
+  call void @print(i64 %d0)
+
+  ; ADD, ZERO_2, copying another CAT variable: left as it is
+  %e = call i8* @CAT_new(i64 0)
+  %y2 = call i8* @CAT_new(i64 0)
+  call void @CAT_set(i8* %y2, i64 %n)
+  call void @CAT_add(i8* %e, i8* %y2, i8* %zero)
+  %e0 = call i64 @CAT_get(i8* %e)
+  call void @print(i64 %e0)
+
+  ; ADD, DEST_2: COMMUTE
+  %g = call i8* @CAT_new(i64 0)
+  %y3 = call i8* @CAT_new(i64 0)
+  call void @CAT_set(i8* %g, i64 %n)
+  call void @CAT_set(i8* %y3, i64 3)
+  call void @CAT_add(i8* %g, i8* %y3, i8* %g)
+  %g0 = call i64 @CAT_get(i8* %g)
+  call void @print(i64 %g0)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  call void @f(i64 5)
+  ret i32 0
+}